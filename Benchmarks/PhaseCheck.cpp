@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    PhaseCheck.cpp
+    Checks that an hour of motor playback lands on the exact integer phase,
+    whichever path advanced the playhead. Standalone, no JUCE:
+
+        c++ -O2 -std=c++17 -I Source Benchmarks/PhaseCheck.cpp -o phase_check
+        ./phase_check
+
+    Blocks of random length alternate between the varispeed path (one step
+    per sample, or the fused run of n steps) and the keylock path (the
+    stretcher advancing by n steps per chunk, its position handed back as
+    the playhead). After an hour each speed must sit on step * samples. The
+    double round trip the keylock path used before is run alongside, and its
+    drift printed for comparison.
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include "PlayheadPhase.h"
+
+namespace {
+
+    using ttvst::PlayheadPhase;
+
+    constexpr int64_t kSampleRate = 48000;
+    constexpr int64_t kHour = 3600 * kSampleRate;
+    constexpr int kMaxChunk = 4096;   // the stretcher's maxBlock_ at a large host block
+
+    struct Result
+    {
+        int64_t exact = 0, phase = 0;
+        double roundTripDrift = 0.0;  // samples
+    };
+
+    Result run(double speed, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> blockLength(1, 2048);
+        std::uniform_int_distribution<int> path(0, 2);
+
+        const int64_t step = PlayheadPhase::step(speed);
+        PlayheadPhase ph, roundTrip;
+        int64_t done = 0;
+        while (done < kHour) {
+            const int n = (int)std::min<int64_t>(blockLength(rng), kHour - done);
+            switch (path(rng)) {
+            case 0:     // walk: one step per sample (scratch path at a constant ratio)
+                for (int i = 0; i < n; ++i) ph += step;
+                break;
+            case 1:     // runConstant: n steps at once
+                ph.raw += (int64_t)n * step;
+                break;
+            default: {  // keylock: the stretcher's position, in chunks, becomes the playhead
+                PlayheadPhase position = ph;
+                for (int left = n; left > 0; left -= kMaxChunk)
+                    position += (int64_t)std::min(left, kMaxChunk) * step;
+                ph = position;
+                break;
+            }
+            }
+
+            // before: a double position advanced by speed * n, read back through fromSamples
+            double position = roundTrip.toSamples();
+            position += speed * n;
+            roundTrip = PlayheadPhase::fromSamples(position);
+            done += n;
+        }
+        return { step * kHour, ph.raw, (double)(roundTrip.raw - step * kHour) * PlayheadPhase::invUnit };
+    }
+
+} // namespace
+
+int main()
+{
+    const double speeds[] = { 1.0, 0.92, 1.08, 1.0 + 1.0 / 3.0, 0.5 + 1.0 / 7.0, 0.999, 1.16 };
+    int failures = 0;
+    uint32_t seed = 1;
+    for (const double speed : speeds) {
+        const auto r = run(speed, seed++);
+        const bool ok = r.phase == r.exact;
+        failures += ok ? 0 : 1;
+        std::printf("speed %.6f  phase %s (off by %" PRId64 " raw)  double round trip drifts %+.3e samples\n",
+            speed, ok ? "exact" : "WRONG", r.phase - r.exact, r.roundTripDrift);
+    }
+    std::printf(failures == 0 ? "ok\n" : "%d speed(s) drifted\n", failures);
+    return failures == 0 ? 0 : 1;
+}
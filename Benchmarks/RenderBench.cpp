@@ -0,0 +1,283 @@
+/*
+  ==============================================================================
+
+    RenderBench.cpp
+    Times the varispeed gather loops (Source/RenderKernels.h) on planar and
+    interleaved tracks. Standalone, no JUCE:
+
+        c++ -O3 -std=c++17 -I Source Benchmarks/RenderBench.cpp -o render_bench
+        ./render_bench
+
+    Each case renders the same precomputed playhead path, so only the reads
+    and the interpolation differ between layouts. On an x86-64 dev box the
+    4-channel frames win every case (x1.1 to x2.4); stereo frames win with
+    sinc (x1.5 to x2) and on needle jumps, but lose with linear and Hermite
+    on motor and scratch paths (about x0.75 to x0.9). That is why
+    float32Frames is an opt-in storage and not the default. The motor section compares
+    the renderer's per-run dispatch at a constant ratio: walk + gather (the
+    scratch path), the fused constant-ratio gather, and the unity block copy.
+    The last section compares the generic per-channel loops (gather and
+    constant-ratio) with their fixed-channel versions; render::selectKernels
+    lists a fixed loop only where it wins here.
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "RenderKernels.h"
+
+namespace {
+
+    using namespace ttvst;
+
+    constexpr int kGuard = 16;
+    constexpr int kTrackFrames = 8 << 20;    // ~3 minutes at 44.1 kHz
+    constexpr int kBlock = 512;
+    constexpr int kRenderSamples = 1 << 21;
+
+    struct Track
+    {
+        int numCh = 0;
+        std::vector<std::vector<float>> planar;    // guarded like LoadedAudio::buffer
+        std::vector<float> frames;                 // guarded like LoadedAudio::frames
+        int stride = 0, offset = 0;
+
+        const float* channel(int ch) const { return planar[(size_t)ch].data() + kGuard; }
+        const float* framePointer() const { return frames.data() + offset + kGuard * stride; }
+    };
+
+    Track makeTrack(int numCh)
+    {
+        Track t;
+        t.numCh = numCh;
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+        const size_t n = (size_t)kTrackFrames + 2 * kGuard;
+        t.planar.assign((size_t)numCh, std::vector<float>(n, 0.0f));
+        for (auto& c : t.planar)
+            for (size_t i = kGuard; i < n - kGuard; ++i)
+                c[i] = noise(rng);
+
+        t.stride = numCh <= 2 ? 2 : 4;
+        t.frames.assign((size_t)t.stride * n + 3, 0.0f);
+        t.offset = (int)((4 - (reinterpret_cast<uintptr_t>(t.frames.data()) / sizeof(float)) % 4) % 4);
+        for (int ch = 0; ch < numCh; ++ch)
+            for (size_t i = 0; i < n; ++i)
+                t.frames[(size_t)t.offset + i * (size_t)t.stride + (size_t)ch] = t.planar[(size_t)ch][i];
+        return t;
+    }
+
+    struct Path
+    {
+        const char* name;
+        std::vector<int64_t> index;
+        std::vector<double> frac;
+    };
+
+    // Playhead positions for kRenderSamples output samples, kept inside the track
+    Path makePath(const char* name, double (*ratioAt)(int64_t, std::mt19937&), bool jumps)
+    {
+        Path p{ name, std::vector<int64_t>(kRenderSamples), std::vector<double>(kRenderSamples) };
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> anywhere(16.0, kTrackFrames - 16.0);
+        double pos = kTrackFrames / 2.0;
+        for (int i = 0; i < kRenderSamples; ++i) {
+            if (jumps && i % 64 == 0) pos = anywhere(rng);
+            pos = std::clamp(pos + ratioAt(i, rng), 8.0, kTrackFrames - 8.0);
+            p.index[(size_t)i] = (int64_t)std::floor(pos);
+            p.frac[(size_t)i] = pos - std::floor(pos);
+        }
+        return p;
+    }
+
+    template <typename Fn>
+    double nsPerSample(Fn&& renderBlock)
+    {
+        double best = 1e30;
+        for (int rep = 0; rep < 3; ++rep) {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int from = 0; from < kRenderSamples; from += kBlock)
+                renderBlock(from);
+            const auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / kRenderSamples);
+        }
+        return best;
+    }
+
+    template <typename Reader>
+    void runCase(const char* readerName, const Track& t, const Path& path)
+    {
+        std::vector<std::vector<float>> outStore((size_t)t.numCh, std::vector<float>(kRenderSamples));
+        std::vector<float*> out;
+        std::vector<const float*> chans;
+        std::vector<int> lane;
+        for (int ch = 0; ch < t.numCh; ++ch) {
+            out.push_back(outStore[(size_t)ch].data());
+            chans.push_back(t.channel(ch));
+            lane.push_back(ch);
+        }
+
+        const double planar = nsPerSample([&](int from) {
+            render::gatherPlanar<Reader>(chans.data(), t.numCh, path.index.data(), path.frac.data(), out.data(),
+                from, from + kBlock);
+        });
+        const double framed = nsPerSample([&](int from) {
+            if (t.stride == 4)
+                render::gatherFrames<Reader, 4>(t.framePointer(), lane.data(), t.numCh, path.index.data(),
+                    path.frac.data(), out.data(), from, from + kBlock);
+            else
+                render::gatherFrames<Reader, 2>(t.framePointer(), lane.data(), t.numCh, path.index.data(),
+                    path.frac.data(), out.data(), from, from + kBlock);
+        });
+
+        std::printf("%-8s %dch  %-8s  planar %6.2f ns  interleaved %6.2f ns  x%.2f\n",
+            path.name, t.numCh, readerName, planar, framed, planar / framed);
+    }
+
+    // Motor at a fixed ratio, planar: what each of the renderer's run kinds costs
+    template <typename Reader>
+    void runMotorCase(const char* readerName, const Track& t, double ratio)
+    {
+        std::vector<std::vector<float>> outStore((size_t)t.numCh, std::vector<float>(kBlock));
+        std::vector<float*> out;
+        std::vector<const float*> chans;
+        for (int ch = 0; ch < t.numCh; ++ch) {
+            out.push_back(outStore[(size_t)ch].data());
+            chans.push_back(t.channel(ch));
+        }
+        std::vector<int64_t> index(kBlock);
+        std::vector<double> frac(kBlock);
+        const int64_t step = PlayheadPhase::step(ratio);
+        const int64_t wrapAt = PlayheadPhase::fromIndex(kTrackFrames - 4 * kBlock).raw;
+        auto startOf = [&](int from) { return (PlayheadPhase::fromIndex(1024).raw + (int64_t)from * step) % wrapAt; };
+
+        const double walked = nsPerSample([&](int from) {
+            PlayheadPhase ph{ startOf(from) };
+            for (int i = 0; i < kBlock; ++i) {
+                index[(size_t)i] = ph.index();
+                frac[(size_t)i] = ph.frac<double>();
+                ph += step;
+            }
+            render::gatherPlanar<Reader>(chans.data(), t.numCh, index.data(), frac.data(), out.data(), 0, kBlock);
+        });
+        const double constant = nsPerSample([&](int from) {
+            render::gatherConstant<Reader>(chans.data(), t.numCh, startOf(from), step, out.data(), 0, kBlock);
+        });
+        std::printf("motor %.3f %dch  %-8s  walk+gather %6.2f ns  constant %6.2f ns  x%.2f",
+            ratio, t.numCh, readerName, walked, constant, walked / constant);
+        if (ratio == 1.0) {
+            const double copied = nsPerSample([&](int from) {
+                const int64_t first = PlayheadPhase{ startOf(from) }.index();
+                for (int ch = 0; ch < t.numCh; ++ch)
+                    std::memcpy(out[(size_t)ch], chans[(size_t)ch] + first, sizeof(float) * kBlock);
+            });
+            std::printf("  copy %6.2f ns  x%.2f", copied, walked / copied);
+        }
+        std::printf("\n");
+    }
+
+    // Generic gatherPlanar against the fixed-channel loop for this channel count
+    template <typename Reader>
+    void runFixedCase(const char* readerName, const Track& t, const Path& path)
+    {
+        std::vector<std::vector<float>> outStore((size_t)t.numCh, std::vector<float>(kRenderSamples));
+        std::vector<float*> out;
+        std::vector<const float*> chans;
+        for (int ch = 0; ch < t.numCh; ++ch) {
+            out.push_back(outStore[(size_t)ch].data());
+            chans.push_back(t.channel(ch));
+        }
+        const double generic = nsPerSample([&](int from) {
+            render::gatherPlanar<Reader>(chans.data(), t.numCh, path.index.data(), path.frac.data(), out.data(),
+                from, from + kBlock);
+        });
+        const double fixed = nsPerSample([&](int from) {
+            switch (t.numCh) {
+            case 1: render::gatherPlanarFixed<Reader, 1>(chans.data(), 1, path.index.data(), path.frac.data(), out.data(), from, from + kBlock); break;
+            case 2: render::gatherPlanarFixed<Reader, 2>(chans.data(), 2, path.index.data(), path.frac.data(), out.data(), from, from + kBlock); break;
+            default: render::gatherPlanarFixed<Reader, 0>(chans.data(), t.numCh, path.index.data(), path.frac.data(), out.data(), from, from + kBlock); break;
+            }
+        });
+        std::printf("%-8s %dch  %-8s  generic %6.2f ns  fixed %6.2f ns  x%.2f\n",
+            path.name, t.numCh, readerName, generic, fixed, generic / fixed);
+    }
+
+    // gatherConstant against gatherConstantFixed at a constant off-unity ratio
+    template <typename Reader>
+    void runFixedConstantCase(const char* readerName, const Track& t, double ratio)
+    {
+        std::vector<std::vector<float>> outStore((size_t)t.numCh, std::vector<float>(kBlock));
+        std::vector<float*> out;
+        std::vector<const float*> chans;
+        for (int ch = 0; ch < t.numCh; ++ch) {
+            out.push_back(outStore[(size_t)ch].data());
+            chans.push_back(t.channel(ch));
+        }
+        const int64_t step = PlayheadPhase::step(ratio);
+        const int64_t wrapAt = PlayheadPhase::fromIndex(kTrackFrames - 4 * kBlock).raw;
+        auto startOf = [&](int from) { return (PlayheadPhase::fromIndex(1024).raw + (int64_t)from * step) % wrapAt; };
+
+        const double generic = nsPerSample([&](int from) {
+            render::gatherConstant<Reader>(chans.data(), t.numCh, startOf(from), step, out.data(), 0, kBlock);
+        });
+        const double fixed = nsPerSample([&](int from) {
+            switch (t.numCh) {
+            case 1: render::gatherConstantFixed<Reader, 1>(chans.data(), 1, startOf(from), step, out.data(), 0, kBlock); break;
+            case 2: render::gatherConstantFixed<Reader, 2>(chans.data(), 2, startOf(from), step, out.data(), 0, kBlock); break;
+            default: render::gatherConstantFixed<Reader, 0>(chans.data(), t.numCh, startOf(from), step, out.data(), 0, kBlock); break;
+            }
+        });
+        std::printf("constant %.3f %dch  %-8s  generic %6.2f ns  fixed %6.2f ns  x%.2f\n",
+            ratio, t.numCh, readerName, generic, fixed, generic / fixed);
+    }
+
+    double motor(int64_t, std::mt19937&) { return 1.0; }
+    double scratch(int64_t i, std::mt19937&) { return 12.0 * std::sin(2.0 * 3.14159265358979 * (double)i / 11025.0); }
+    double none(int64_t, std::mt19937&) { return 0.37; }
+
+} // namespace
+
+int main()
+{
+    const Path paths[] = {
+        makePath("motor", motor, false),
+        makePath("scratch", scratch, false),
+        makePath("needle", none, true),     // random jumps every 64 samples: the cache-miss worst case
+    };
+
+    for (int numCh : { 2, 4 }) {
+        const Track t = makeTrack(numCh);
+        for (const auto& path : paths) {
+            runCase<interp::Linear>("linear", t, path);
+            runCase<interp::Hermite>("hermite", t, path);
+            runCase<interp::Sinc>("sinc", t, path);
+        }
+    }
+
+    const Track stereo = makeTrack(2);
+    for (double ratio : { 1.0, 1.013 }) {
+        runMotorCase<interp::Linear>("linear", stereo, ratio);
+        runMotorCase<interp::Hermite>("hermite", stereo, ratio);
+        runMotorCase<interp::Sinc>("sinc", stereo, ratio);
+    }
+
+    for (int numCh : { 1, 2, 4 }) {
+        const Track t = makeTrack(numCh);
+        for (const auto& path : paths) {
+            runFixedCase<interp::Linear>("linear", t, path);
+            runFixedCase<interp::Hermite>("hermite", t, path);
+            runFixedCase<interp::Sinc>("sinc", t, path);
+        }
+        runFixedConstantCase<interp::Linear>("linear", t, 1.013);
+        runFixedConstantCase<interp::Hermite>("hermite", t, 1.013);
+        runFixedConstantCase<interp::Sinc>("sinc", t, 1.013);
+    }
+    return 0;
+}
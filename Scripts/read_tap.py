@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Read a .ttap signal-tap file written by ttvst::tap::SignalTapRecorder.
+
+    python read_tap.py capture.ttap                 # list streams
+    python read_tap.py capture.ttap ratio out.csv   # dump one stream as time,value...
+
+As a module: read_tap(path) -> (sample_rate, {name: (times, values)}), where times is
+an int64 array with one entry per item and values is a float64 array of shape
+(items, width). Per-sample streams get time + i for item i of a chunk; "knots"
+carries its own time in column 0.
+"""
+import sys
+
+import numpy as np
+
+HEADER = np.dtype([("magic", "S8"), ("version", "<u4"), ("num_streams", "<u4"),
+                   ("sample_rate", "<f8"), ("reserved", "<u8")])
+STREAM = np.dtype([("name", "S40"), ("id", "<u4"), ("width", "<u4")])
+CHUNK = np.dtype([("magic", "<u4"), ("stream", "<u4"), ("time", "<i8"),
+                  ("count", "<u4"), ("reserved", "<u4")])
+CHUNK_MAGIC = 0x4B4E4843
+
+
+def read_tap(path):
+    data = np.memmap(path, dtype=np.uint8, mode="r")
+    header = data[:HEADER.itemsize].view(HEADER)[0]
+    if header["magic"] != b"TTVSTAP":
+        raise ValueError(f"{path}: not a tap file")
+
+    offset = HEADER.itemsize
+    streams = data[offset:offset + STREAM.itemsize * header["num_streams"]].view(STREAM)
+    offset += streams.nbytes
+
+    parts = {int(s["id"]): ([], []) for s in streams}
+    widths = {int(s["id"]): int(s["width"]) for s in streams}
+    while offset + CHUNK.itemsize <= len(data):
+        chunk = data[offset:offset + CHUNK.itemsize].view(CHUNK)[0]
+        if chunk["magic"] != CHUNK_MAGIC:
+            raise ValueError(f"{path}: bad chunk at byte {offset}")
+        offset += CHUNK.itemsize
+        sid, count = int(chunk["stream"]), int(chunk["count"])
+        nbytes = count * widths[sid] * 8
+        if offset + nbytes > len(data):
+            break   # cut short by a crash, keep what is complete
+        values = data[offset:offset + nbytes].view("<f8").reshape(count, widths[sid])
+        offset += nbytes
+        parts[sid][0].append(chunk["time"] + np.arange(count, dtype=np.int64))
+        parts[sid][1].append(values)
+
+    result = {}
+    for s in streams:
+        times, values = parts[int(s["id"])]
+        result[s["name"].decode()] = (
+            np.concatenate(times) if times else np.zeros(0, np.int64),
+            np.concatenate(values) if values else np.zeros((0, int(s["width"]))))
+    return float(header["sample_rate"]), result
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+    sample_rate, streams = read_tap(argv[1])
+    if len(argv) < 4:
+        print(f"sample rate {sample_rate:g}")
+        for name, (times, values) in streams.items():
+            span = f"{times[0]}..{times[-1]}" if len(times) else "-"
+            print(f"{name:12s} {len(times):10d} items  width {values.shape[1]}  time {span}")
+        return 0
+    times, values = streams[argv[2]]
+    np.savetxt(argv[3], np.column_stack([times, values]), delimiter=",", fmt="%.12g")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
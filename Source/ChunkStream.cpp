@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    ChunkStream.cpp
+
+  ==============================================================================
+*/
+
+#include "ChunkStream.h"
+#include <limits>
+
+namespace ttvst {
+
+    ChunkStream::ChunkStream(std::unique_ptr<juce::AudioFormatReader> reader)
+        : juce::Thread("ttvst chunk stream"), reader_(std::move(reader))
+    {
+        numChannels_ = (int)reader_->numChannels;
+        numSamples_ = (int)juce::jmin<juce::int64>(reader_->lengthInSamples, std::numeric_limits<int>::max() - kChunkFrames);
+        numChunks_ = (numSamples_ + kChunkFrames - 1) / kChunkFrames;
+        sampleRate_ = reader_->sampleRate;
+
+        // only the MP3 reader learns seek positions from a read-through; PCM seeks by
+        // arithmetic and FLAC/Ogg readers keep no table, a pass would read the file for nothing
+        if (!reader_->getFormatName().startsWithIgnoreCase("MP3"))
+            indexedChunks_.store(numChunks_);
+
+        for (auto& slot : slots_)
+            slot.audio.setSize(numChannels_, kChunkFrames);
+        slotOf_ = std::make_unique<std::atomic<int>[]>((size_t)juce::jmax(1, numChunks_));
+        for (int c = 0; c < numChunks_; ++c)
+            slotOf_[(size_t)c].store(-1, std::memory_order_relaxed);
+        scanBuffer_.setSize(numChannels_, kChunkFrames);
+        for (auto& a : anchorChunk_)
+            a.store(-1, std::memory_order_relaxed);
+
+        startThread(juce::Thread::Priority::high);   // a miss is an audible gap
+    }
+
+    ChunkStream::~ChunkStream()
+    {
+        stopThread(4000);
+    }
+
+    void ChunkStream::readSpan(int ch, int start, int n, float* dest) const noexcept
+    {
+        while (n > 0) {
+            if (start < 0 || start >= numSamples_) {
+                // guards and beyond: silence up to the track (or all of it)
+                const int len = start < 0 ? juce::jmin(n, -start) : n;
+                std::memset(dest, 0, sizeof(float) * (size_t)len);
+                start += len; dest += len; n -= len;
+                continue;
+            }
+
+            const int chunk = start / kChunkFrames;
+            const int offset = start - chunk * kChunkFrames;
+            const int len = juce::jmin(n, kChunkFrames - offset);
+
+            bool copied = false;
+            const int s = slotOf_[(size_t)chunk].load(std::memory_order_seq_cst);
+            if (s >= 0) {
+                const auto& slot = slots_[(size_t)s];
+                slot.readers.fetch_add(1, std::memory_order_seq_cst);
+                // still the same chunk once pinned: the decode thread cannot take it now
+                if (slotOf_[(size_t)chunk].load(std::memory_order_seq_cst) == s) {
+                    std::memcpy(dest, slot.audio.getReadPointer(ch, offset), sizeof(float) * (size_t)len);
+                    copied = true;
+                }
+                slot.readers.fetch_sub(1, std::memory_order_release);
+            }
+            if (!copied) {
+                std::memset(dest, 0, sizeof(float) * (size_t)len);
+                misses_.fetch_add(1, std::memory_order_relaxed);
+            }
+            start += len; dest += len; n -= len;
+        }
+    }
+
+    void ChunkStream::run()
+    {
+        bool background = false;   // lowered for the index pass
+        auto setBackground = [this, &background](bool b) {
+            if (b == background) return;
+            background = b;
+            setPriority(b ? juce::Thread::Priority::low : juce::Thread::Priority::high);
+        };
+
+        while (!threadShouldExit()) {
+            if (decks_.load(std::memory_order_relaxed) == 0) {
+                wait(100);   // only cached: idle until a deck plays it (addDeck notifies)
+                continue;
+            }
+            const int wanted = nextWanted();
+            if (wanted >= 0) {
+                setBackground(false);
+                decodeChunk(wanted);
+                continue;
+            }
+            if (indexedChunks_.load(std::memory_order_relaxed) < numChunks_) {
+                setBackground(true);
+                scanNext();
+                wait(1);   // background work: leave the core to everything else between chunks
+                continue;
+            }
+            setBackground(false);
+            wait(5);
+        }
+    }
+
+    // Nearest missing chunk of the window around the playhead, ahead before behind;
+    // then the anchors'
+    int ChunkStream::nextWanted() const noexcept
+    {
+        const int c = playheadChunk_.load(std::memory_order_relaxed);
+        const int dir = direction_.load(std::memory_order_relaxed);
+        auto missing = [this](int chunk) {
+            return chunk >= 0 && chunk < numChunks_ && slotOf_[(size_t)chunk].load(std::memory_order_relaxed) < 0;
+        };
+        for (int k = 0; k <= kAhead; ++k) {
+            if (missing(c + dir * k)) return c + dir * k;
+            if (k > 0 && k <= kBehind && missing(c - dir * k)) return c - dir * k;
+        }
+        for (const auto& anchor : anchorChunk_) {
+            const int a = anchor.load(std::memory_order_relaxed);
+            if (a < 0) continue;
+            for (int k = 0; k < kAnchorChunks; ++k)
+                if (missing(a + k)) return a + k;
+        }
+        return -1;
+    }
+
+    bool ChunkStream::isAnchored(int chunk) const noexcept
+    {
+        for (const auto& anchor : anchorChunk_) {
+            const int a = anchor.load(std::memory_order_relaxed);
+            if (a >= 0 && chunk >= a && chunk < a + kAnchorChunks) return true;
+        }
+        return false;
+    }
+
+    // A free slot, or the one holding the chunk farthest from nearChunk that nobody reads;
+    // anchored chunks only when nothing else is left
+    int ChunkStream::takeSlot(int nearChunk) noexcept
+    {
+        for (;;) {
+            int best = -1, bestDistance = -1;
+            bool bestAnchored = true;
+            for (int s = 0; s < kNumSlots; ++s) {
+                const int held = slots_[(size_t)s].chunk;
+                if (held < 0) return s;
+                const int d = std::abs(held - nearChunk);
+                const bool anchored = isAnchored(held);
+                if ((bestAnchored && !anchored) || (anchored == bestAnchored && d > bestDistance)) {
+                    best = s; bestDistance = d; bestAnchored = anchored;
+                }
+            }
+
+            auto& slot = slots_[(size_t)best];
+            slotOf_[(size_t)slot.chunk].store(-1, std::memory_order_seq_cst);
+            if (slot.readers.load(std::memory_order_seq_cst) == 0) {
+                slot.chunk = -1;
+                return best;
+            }
+            // being copied from right now: put it back and let the block finish
+            slotOf_[(size_t)slot.chunk].store(best, std::memory_order_seq_cst);
+            juce::Thread::yield();
+        }
+    }
+
+    void ChunkStream::decodeChunk(int chunk) noexcept
+    {
+        const int s = takeSlot(playheadChunk_.load(std::memory_order_relaxed));
+        auto& slot = slots_[(size_t)s];
+        const juce::int64 start = (juce::int64)chunk * kChunkFrames;
+        const int len = (int)juce::jmin<juce::int64>(kChunkFrames, numSamples_ - start);
+
+        slot.audio.clear();
+        if (!reader_->read(&slot.audio, 0, len, start, true, true))
+            DBG("ChunkStream: read failed at chunk " << chunk);   // keep the silence, do not retry forever
+
+        slot.chunk = chunk;
+        slotOf_[(size_t)chunk].store(s, std::memory_order_seq_cst);   // publishes the samples
+    }
+
+    // One more chunk of the index pass, read and dropped: the reader keeps what it learnt
+    void ChunkStream::scanNext() noexcept
+    {
+        const int chunk = indexedChunks_.load(std::memory_order_relaxed);
+        const juce::int64 start = (juce::int64)chunk * kChunkFrames;
+        const int len = (int)juce::jmin<juce::int64>(kChunkFrames, numSamples_ - start);
+        reader_->read(&scanBuffer_, 0, len, start, true, true);
+        indexedChunks_.store(chunk + 1, std::memory_order_relaxed);
+    }
+
+} // namespace ttvst
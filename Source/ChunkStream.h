@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    ChunkStream.h
+    Decodes a track from disk in fixed-size chunks around the playhead, for
+    compressed files too long to decode into RAM up front.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace ttvst {
+
+    /**
+     * A track that stays on disk. Its decode thread keeps the chunks around the playhead
+     * decoded in a fixed set of slots: kAhead in the play direction and kBehind against
+     * it (a scratch goes both ways), nearest first, evicting whatever lies farthest away.
+     * When nothing is wanted an MP3 is walked once from the start at low priority: the
+     * MP3 reader records frame positions as it passes them, so later seeks anywhere are
+     * lookups instead of scans. That pass is the index; getIndexedProportion reports how
+     * far it has got. Other formats seek without one (PCM by arithmetic; FLAC and Ogg
+     * gain nothing from a read-through) and count as indexed from the start.
+     *
+     * Besides the playhead, up to kNumAnchors anchors (the sampler's hot cues, or where a
+     * pad voice is playing now) keep kAnchorChunks chunks each decoded and are never
+     * evicted for the playhead window, so a pad far from the needle does not play silence.
+     *
+     * The thread only works while some deck plays the track (addDeck/removeDeck): a
+     * streamed track that just sits in TrackCache costs no CPU.
+     *
+     * The audio thread reads through readSpan/getSample, which never wait: a chunk that
+     * is not resident reads as silence and counts a miss. A reader pins the slot it copies
+     * from; the decode thread only reuses a slot nobody has pinned.
+     */
+    class ChunkStream : private juce::Thread
+    {
+    public:
+        static constexpr int kChunkFrames = 1 << 14;   // ~0.37 s at 44.1 kHz
+        static constexpr int kNumSlots = 32;           // 4 MiB of stereo float
+        static constexpr int kAhead = 8;               // chunks decoded ahead of the playhead
+        static constexpr int kBehind = 4;              // and behind it
+        static constexpr int kNumAnchors = 8;          // one per hot cue
+        static constexpr int kAnchorChunks = 2;        // kept from each anchor on
+
+        // Loader thread. Starts decoding around sample 0.
+        explicit ChunkStream(std::unique_ptr<juce::AudioFormatReader> reader);
+        ~ChunkStream() override;
+
+        int getNumChannels() const noexcept { return numChannels_; }
+        int getNumSamples() const noexcept { return numSamples_; }
+        double getSampleRate() const noexcept { return sampleRate_; }
+
+        // Audio thread. [start, start + n) of one channel, silence outside the track and
+        // wherever the chunk is not decoded yet.
+        void readSpan(int ch, int start, int n, float* dest) const noexcept;
+        float getSample(int ch, int index) const noexcept
+        {
+            float s = 0.0f;
+            readSpan(ch, index, 1, &s);
+            return s;
+        }
+
+        // Message/loader thread: a deck starts / stops playing this track. Counts nest.
+        void addDeck() noexcept
+        {
+            if (decks_.fetch_add(1, std::memory_order_relaxed) == 0)
+                notify();
+        }
+        void removeDeck() noexcept { decks_.fetch_sub(1, std::memory_order_relaxed); }
+
+        // Audio thread: anchor i at a sample, < 0 releases it
+        void setAnchor(int i, int64_t sample) noexcept
+        {
+            if (i < 0 || i >= kNumAnchors) return;
+            const int chunk = sample < 0 ? -1
+                : (int)juce::jlimit<int64_t>(0, juce::jmax(0, numChunks_ - 1), sample / kChunkFrames);
+            anchorChunk_[(size_t)i].store(chunk, std::memory_order_relaxed);
+        }
+
+        // Audio thread, once per block: where the deck plays and which way (sign)
+        void setPlayhead(int64_t sample, int direction) noexcept
+        {
+            playheadChunk_.store((int)juce::jlimit<int64_t>(0, juce::jmax(0, numChunks_ - 1), sample / kChunkFrames),
+                std::memory_order_relaxed);
+            direction_.store(direction < 0 ? -1 : 1, std::memory_order_relaxed);
+        }
+
+        // Any thread
+        size_t getCacheBytes() const noexcept { return sizeof(float) * (size_t)kNumSlots * (size_t)numChannels_ * kChunkFrames; }
+        double getIndexedProportion() const noexcept
+        {
+            return numChunks_ > 0 ? (double)indexedChunks_.load(std::memory_order_relaxed) / numChunks_ : 1.0;
+        }
+        size_t getMisses() const noexcept { return misses_.load(std::memory_order_relaxed); }
+
+        // fn(const void* data, size_t bytes) for every slot's sample memory
+        template <typename Fn>
+        void forEachRegion(Fn&& fn) const
+        {
+            for (const auto& slot : slots_)
+                for (int ch = 0; ch < slot.audio.getNumChannels(); ++ch)
+                    fn(static_cast<const void*>(slot.audio.getReadPointer(ch)), sizeof(float) * (size_t)kChunkFrames);
+        }
+
+    private:
+        struct Slot
+        {
+            juce::AudioBuffer<float> audio;           // kChunkFrames per channel, zero past the track end
+            int chunk = -1;                           // decode thread's record of what it holds
+            mutable std::atomic<int> readers{ 0 };    // audio-thread pins
+        };
+
+        void run() override;
+        int nextWanted() const noexcept;
+        void decodeChunk(int chunk) noexcept;
+        int takeSlot(int nearChunk) noexcept;
+        bool isAnchored(int chunk) const noexcept;
+        void scanNext() noexcept;
+
+        std::unique_ptr<juce::AudioFormatReader> reader_;   // decode thread only
+        int numChannels_ = 0;
+        int numSamples_ = 0;
+        int numChunks_ = 0;
+        double sampleRate_ = 0.0;
+
+        std::array<Slot, kNumSlots> slots_;
+        std::unique_ptr<std::atomic<int>[]> slotOf_;        // chunk -> slot, -1 = not resident
+        juce::AudioBuffer<float> scanBuffer_;
+
+        std::atomic<int> playheadChunk_{ 0 };
+        std::atomic<int> direction_{ 1 };
+        std::atomic<int> indexedChunks_{ 0 };
+        std::atomic<int> decks_{ 0 };
+        std::array<std::atomic<int>, kNumAnchors> anchorChunk_;   // -1 = unused
+        mutable std::atomic<size_t> misses_{ 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(ChunkStream)
+    };
+
+} // namespace ttvst
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    Fft.h
+    Preallocated radix-2 complex FFT (split real/imag arrays).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace ttvst::dsp {
+
+    /**
+     * In-place iterative radix-2 FFT on separate re/im arrays.
+     * All tables are built in prepare(); perform() never allocates.
+     * Twiddles are stored per stage and contiguously, so each butterfly pass is a
+     * unit-stride loop over re/im/cos/sin that compilers vectorize.
+     */
+    class Fft
+    {
+    public:
+        void prepare(int order)
+        {
+            size_ = 1 << order;
+            const size_t n = (size_t)size_;
+
+            bitrev_.assign(n, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t r = 0;
+                for (int b = 0; b < order; ++b)
+                    if (i & ((size_t)1 << b)) r |= (size_t)1 << (order - 1 - b);
+                bitrev_[i] = (unsigned)r;
+            }
+
+            // stage with half-length h uses twiddles [h - 1, 2h - 1)
+            cos_.assign(n, 0.0f);
+            sin_.assign(n, 0.0f);
+            for (size_t h = 1; h < n; h <<= 1)
+                for (size_t j = 0; j < h; ++j)
+                {
+                    const double a = -M_PI_VALUE * (double)j / (double)h;
+                    cos_[h - 1 + j] = (float)std::cos(a);
+                    sin_[h - 1 + j] = (float)std::sin(a);
+                }
+        }
+
+        int getSize() const noexcept { return size_; }
+
+        // Forward transform (no scaling)
+        void perform(float* re, float* im) const noexcept { run(re, im, false); }
+
+        // Inverse transform, scaled by 1/N
+        void performInverse(float* re, float* im) const noexcept
+        {
+            run(re, im, true);
+            const float scale = 1.0f / (float)size_;
+            for (int i = 0; i < size_; ++i) { re[i] *= scale; im[i] *= scale; }
+        }
+
+    private:
+        static constexpr double M_PI_VALUE = 3.14159265358979323846;
+
+        void run(float* re, float* im, bool inverse) const noexcept
+        {
+            const size_t n = (size_t)size_;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const size_t j = bitrev_[i];
+                if (j > i)
+                {
+                    std::swap(re[i], re[j]);
+                    std::swap(im[i], im[j]);
+                }
+            }
+
+            const float sign = inverse ? -1.0f : 1.0f;
+            for (size_t h = 1; h < n; h <<= 1)
+            {
+                const float* wc = cos_.data() + h - 1;
+                const float* ws = sin_.data() + h - 1;
+                for (size_t base = 0; base < n; base += 2 * h)
+                {
+                    float* __restrict ar = re + base;
+                    float* __restrict ai = im + base;
+                    float* __restrict br = re + base + h;
+                    float* __restrict bi = im + base + h;
+                    for (size_t j = 0; j < h; ++j)
+                    {
+                        const float c = wc[j], s = sign * ws[j];
+                        const float tr = br[j] * c - bi[j] * s;
+                        const float ti = br[j] * s + bi[j] * c;
+                        br[j] = ar[j] - tr;
+                        bi[j] = ai[j] - ti;
+                        ar[j] += tr;
+                        ai[j] += ti;
+                    }
+                }
+            }
+        }
+
+        int size_ = 0;
+        std::vector<unsigned> bitrev_;
+        std::vector<float> cos_, sin_;
+    };
+
+} // namespace ttvst::dsp
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    Interpolators.h
+    Fractional-position sample readers for the varispeed renderer.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <cmath>
+
+namespace ttvst::interp {
+
+    // Cheapest last; the load governor steps down this list
+    enum Kind : int { linear = 0, hermite, sinc, kNumKinds };
+
+    /*
+     * Each reader takes p pointing at the sample at or before the position and the
+     * fraction past it, and reads p[-kBefore] .. p[kAfter]. The renderer keeps that
+     * many samples valid around every region (track guards, loop seam padding,
+     * decoded windows), so no reader ever tests a boundary.
+     * weights() gives the same filter as kBefore + kAfter + 1 tap weights, in float or
+     * double, for loops where one set of weights covers every channel of a tap.
+     */
+    constexpr int kMaxBefore = 3;
+    constexpr int kMaxAfter = 4;
+
+    struct Linear
+    {
+        static constexpr int kBefore = 0, kAfter = 1;
+
+        template <typename FloatType>
+        static FloatType read(const float* p, double frac) noexcept
+        {
+            return (FloatType)p[0] + (FloatType)frac * ((FloatType)p[1] - (FloatType)p[0]);
+        }
+
+        template <typename T>
+        static void weights(double frac, T* w) noexcept
+        {
+            w[0] = (T)(1.0 - frac);
+            w[1] = (T)frac;
+        }
+    };
+
+    // 4-point Catmull-Rom: continuous slope, no overshoot on a ramp
+    struct Hermite
+    {
+        static constexpr int kBefore = 1, kAfter = 2;
+
+        template <typename FloatType>
+        static FloatType read(const float* p, double frac) noexcept
+        {
+            const FloatType x = (FloatType)frac;
+            const FloatType ym1 = p[-1], y0 = p[0], y1 = p[1], y2 = p[2];
+            const FloatType c1 = (FloatType)0.5 * (y1 - ym1);
+            const FloatType c2 = ym1 - (FloatType)2.5 * y0 + (FloatType)2 * y1 - (FloatType)0.5 * y2;
+            const FloatType c3 = (FloatType)0.5 * (y2 - ym1) + (FloatType)1.5 * (y0 - y1);
+            return ((c3 * x + c2) * x + c1) * x + y0;
+        }
+
+        template <typename T>
+        static void weights(double frac, T* w) noexcept
+        {
+            const T x = (T)frac;
+            w[0] = ((T(-0.5) * x + T(1)) * x - T(0.5)) * x;
+            w[1] = (T(1.5) * x - T(2.5)) * x * x + T(1);
+            w[2] = ((T(-1.5) * x + T(2)) * x + T(0.5)) * x;
+            w[3] = (T(0.5) * x - T(0.5)) * x * x;
+        }
+    };
+
+    /**
+     * 8-tap Kaiser-windowed sinc (beta 6) from a table of kPhases fractions, nearest
+     * phase. Exact at integer positions and within -50 dB up to about a quarter of the
+     * sample rate. No anti-aliasing beyond that: a fast scratch above unity aliases
+     * as it does on the other readers.
+     */
+    struct Sinc
+    {
+        static constexpr int kBefore = 3, kAfter = 4;
+        static constexpr int kTaps = kBefore + kAfter + 1;
+        static constexpr int kPhases = 512;
+        static constexpr double kBeta = 6.0;
+
+        // Built on first use; prepareToPlay calls this so the audio thread never does
+        static const float* table() noexcept
+        {
+            static const auto t = [] {
+                std::array<float, (size_t)((kPhases + 1) * kTaps)> c{};
+                const double pi = 3.14159265358979323846;
+                auto besselI0 = [](double x) {
+                    double sum = 1.0, term = 1.0;
+                    for (int k = 1; k < 32; ++k) {
+                        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                        sum += term;
+                    }
+                    return sum;
+                };
+                for (int ph = 0; ph <= kPhases; ++ph) {
+                    const double frac = (double)ph / kPhases;
+                    double sum = 0.0;
+                    for (int k = 0; k < kTaps; ++k) {
+                        const double x = (double)(k - kBefore) - frac;
+                        const double r = x / (double)kAfter;
+                        double w = 0.0;
+                        if (std::abs(r) < 1.0) {
+                            w = besselI0(kBeta * std::sqrt(1.0 - r * r)) / besselI0(kBeta);
+                            if (x != 0.0) w *= std::sin(pi * x) / (pi * x);
+                        }
+                        c[(size_t)(ph * kTaps + k)] = (float)w;
+                        sum += w;
+                    }
+                    for (int k = 0; k < kTaps; ++k)   // unity gain at DC for every phase
+                        c[(size_t)(ph * kTaps + k)] = (float)(c[(size_t)(ph * kTaps + k)] / sum);
+                }
+                return c;
+            }();
+            return t.data();
+        }
+
+        template <typename FloatType>
+        static FloatType read(const float* p, double frac) noexcept
+        {
+            const float* c = table() + (int)(frac * kPhases + 0.5) * kTaps;
+            const float* s = p - kBefore;
+            FloatType acc = 0;
+            for (int k = 0; k < kTaps; ++k)
+                acc += (FloatType)s[k] * (FloatType)c[k];
+            return acc;
+        }
+
+        template <typename T>
+        static void weights(double frac, T* w) noexcept
+        {
+            const float* c = table() + (int)(frac * kPhases + 0.5) * kTaps;
+            for (int k = 0; k < kTaps; ++k)
+                w[k] = (T)c[k];
+        }
+    };
+
+} // namespace ttvst::interp
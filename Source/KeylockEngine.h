@@ -0,0 +1,321 @@
+/*
+  ==============================================================================
+
+    KeylockEngine.h
+    Time stretching for motor playback: tempo follows the pitch fader,
+    pitch stays put. WSOLA (cheap) or phase vocoder (cleaner).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include "LoadedAudio.h"
+#include "PlayheadPhase.h"
+#include "Fft.h"
+
+namespace ttvst {
+
+    /**
+     * Overlap-add time stretcher reading straight from a LoadedAudio.
+     * - reset() primes the overlap so the first output sample is already full level
+     *   and lines up with the requested source position
+     * - process() renders n samples; work per call is bounded by ceil(n / hop) + 1 frames
+     * - mixOutTail() crossfades the not-yet-played overlap into whatever was rendered
+     *   instead (click-free handoff to raw varispeed when a scratch starts)
+     * - positions are PlayheadPhase, advanced by the same integer step as the varispeed
+     *   path: handing the playhead back and forth never rounds it
+     * Everything is allocated in prepare(); reset/process/mixOutTail are audio-thread safe.
+     */
+    class KeylockEngine
+    {
+    public:
+        enum Mode : int { off = 0, wsola, phaseVocoder };
+
+        void prepare(int maxChannels, int maxBlockSize)
+        {
+            numChannels_ = std::max(1, maxChannels);
+            maxBlock_ = std::max(1, maxBlockSize);
+            fft_.prepare(kPvOrder);
+
+            const size_t n = (size_t)kMaxFrame;
+            const size_t fifoSize = (size_t)(maxBlockSize + kMaxFrame);
+            ola_.assign((size_t)numChannels_, std::vector<float>(n, 0.0f));
+            fifo_.assign((size_t)numChannels_, std::vector<float>(fifoSize, 0.0f));
+            phasorRe_.assign((size_t)numChannels_, std::vector<float>(n / 2 + 1, 1.0f));
+            phasorIm_.assign((size_t)numChannels_, std::vector<float>(n / 2 + 1, 0.0f));
+            frame_.assign(n, 0.0f);
+            re_.assign(n, 0.0f);
+            im_.assign(n, 0.0f);
+            monoRef_.assign(n, 0.0f);
+            monoSearch_.assign(n + 2 * kWsolaSearch, 0.0f);
+            window_.assign(n, 0.0f);
+            mode_ = off;
+        }
+
+        Mode getMode() const noexcept { return mode_; }
+
+        // Source position of the next output sample
+        PlayheadPhase getPosition() const noexcept { return position_; }
+
+        void reset(const LoadedAudio& src, PlayheadPhase position, double speed, Mode mode) noexcept
+        {
+            mode_ = mode;
+            frameSize_ = mode == phaseVocoder ? (1 << kPvOrder) : kWsolaFrame;
+            hop_ = frameSize_ / 4;
+            buildWindow();
+
+            for (auto& o : ola_) std::fill(o.begin(), o.end(), 0.0f);
+            fifoCount_ = 0;
+            firstFrame_ = true;
+            position_ = position;
+
+            // frame j covers output [(j - (K-1)) * hop, ... + frameSize) with K = frameSize / hop;
+            // place frame 0 so the window centres map output time t onto position + t * speed
+            const int overlap = frameSize_ / hop_;
+            const double firstOut = -(double)((overlap - 1) * hop_);
+            analysisPos_ = position;
+            analysisPos_ += PlayheadPhase::fromSamples((firstOut + frameSize_ * 0.5) * speed - frameSize_ * 0.5).raw;
+
+            for (int j = 0; j < overlap - 1; ++j)
+                synthesiseFrame(src, speed);
+            fifoCount_ = 0; // primed: the incomplete head of the overlap is dropped
+        }
+
+        void process(const LoadedAudio& src, float* const* out, int numCh, int start, int n, double speed) noexcept
+        {
+            if (mode_ == off) return;
+            numCh = std::min(numCh, numChannels_);
+
+            while (n > 0)
+            {
+                const int chunk = std::min(n, maxBlock_);
+                while (fifoCount_ < chunk)
+                    synthesiseFrame(src, speed);
+
+                for (int ch = 0; ch < numCh; ++ch)
+                    std::memcpy(out[ch] + start, fifo_[(size_t)srcFor(ch, src)].data(), sizeof(float) * (size_t)chunk);
+                popFifo(chunk);
+                position_ += (int64_t)chunk * PlayheadPhase::step(speed);
+                start += chunk;
+                n -= chunk;
+            }
+        }
+
+        // out = out * fadeIn + (pending keylock output) * fadeOut, then the engine is idle
+        void mixOutTail(const LoadedAudio& src, float* const* out, int numCh, int start, int n) noexcept
+        {
+            if (mode_ == off) return;
+            numCh = std::min(numCh, numChannels_);
+
+            for (int ch = 0; ch < numCh; ++ch)
+            {
+                const auto& fifo = fifo_[(size_t)srcFor(ch, src)];
+                const auto& ola = ola_[(size_t)srcFor(ch, src)];
+                for (int i = 0; i < n; ++i)
+                {
+                    const float g = (float)(i + 1) / (float)(n + 1);
+                    const float tail = i < fifoCount_ ? fifo[(size_t)i]
+                                     : (i - fifoCount_ < frameSize_ - hop_ ? ola[(size_t)(i - fifoCount_)] : 0.0f);
+                    out[ch][start + i] = out[ch][start + i] * g + tail * (1.0f - g);
+                }
+            }
+            mode_ = off;
+        }
+
+    private:
+        static constexpr int kPvOrder = 11;             // 2048-point FFT, hop 512
+        static constexpr int kWsolaFrame = 1024;        // hop 256
+        static constexpr int kMaxFrame = 1 << kPvOrder;
+        static constexpr int kWsolaSearch = 128;        // +- samples of similarity search
+
+        int srcFor(int ch, const LoadedAudio& src) const noexcept
+        {
+            return std::min(ch, std::min(src.getNumChannels(), numChannels_) - 1);
+        }
+
+        void buildWindow() noexcept
+        {
+            // periodic Hann; gain normalises the overlap-add (Hann for WSOLA, Hann^2 for PV)
+            const double twoPi = 6.283185307179586;
+            for (int i = 0; i < frameSize_; ++i)
+                window_[(size_t)i] = (float)(0.5 - 0.5 * std::cos(twoPi * i / frameSize_));
+
+            // periodic Hann overlaps to a constant, so one offset is enough
+            double sum = 0.0;
+            for (int k = 0; k < frameSize_; k += hop_)
+                sum += mode_ == phaseVocoder ? window_[(size_t)k] * window_[(size_t)k]
+                                             : window_[(size_t)k];
+            olaGain_ = (float)(1.0 / sum);
+        }
+
+        // reads [start, start + n) of one channel, zeros outside the track and, while it
+        // still loads, outside what the loader has written (see getDecodedRange)
+        static void readClamped(const LoadedAudio& src, int ch, long long start, int n, float* dest) noexcept
+        {
+            const auto decoded = src.getDecodedRange();
+            auto readPart = [&](long long from, long long to, bool fillBefore, bool fillAfter) noexcept {
+                const long long a = std::max(start, from), b = std::min(start + n, to);
+                if (b <= a) return false;
+                if (fillBefore) std::fill(dest, dest + (a - start), 0.0f);
+                src.readSpan(ch, (int)a, (int)(b - a), dest + (a - start));
+                if (fillAfter) std::fill(dest + (b - start), dest + n, 0.0f);
+                return true;
+            };
+            if (decoded.wrapTo == 0) {
+                if (!readPart(decoded.from, decoded.to, true, true))
+                    std::fill(dest, dest + n, 0.0f);
+                return;
+            }
+            // wrapped: [0, wrapTo) and [from, to) with a gap between them
+            std::fill(dest, dest + n, 0.0f);
+            readPart(0, decoded.wrapTo, false, false);
+            readPart(decoded.from, decoded.to, false, false);
+        }
+
+        void readMono(const LoadedAudio& src, long long start, int n, float* dest) noexcept
+        {
+            const int chans = std::min(src.getNumChannels(), numChannels_);
+            readClamped(src, 0, start, n, dest);
+            for (int ch = 1; ch < chans; ++ch)
+            {
+                readClamped(src, ch, start, n, frame_.data());
+                for (int i = 0; i < n; ++i) dest[i] += frame_[(size_t)i];
+            }
+        }
+
+        void synthesiseFrame(const LoadedAudio& src, double speed) noexcept
+        {
+            const int chans = std::min(src.getNumChannels(), numChannels_);
+            const long long nominal = analysisPos_.index();
+
+            if (mode_ == wsola)
+            {
+                long long startAt = nominal;
+                if (!firstFrame_)
+                {
+                    // best match between the natural continuation of the last frame
+                    // and candidates around the nominal position
+                    const int len = frameSize_ / 2;
+                    readMono(src, prevStart_ + hop_, len, monoRef_.data());
+                    readMono(src, nominal - kWsolaSearch, len + 2 * kWsolaSearch, monoSearch_.data());
+
+                    float best = -1.0e30f;
+                    int bestOffset = 0;
+                    for (int d = 0; d <= 2 * kWsolaSearch; ++d)
+                    {
+                        const float* cand = monoSearch_.data() + d;
+                        float acc = 0.0f;
+                        for (int i = 0; i < len; ++i) acc += cand[i] * monoRef_[(size_t)i];
+                        if (acc > best) { best = acc; bestOffset = d - kWsolaSearch; }
+                    }
+                    startAt = nominal + bestOffset;
+                }
+
+                for (int ch = 0; ch < chans; ++ch)
+                {
+                    readClamped(src, ch, startAt, frameSize_, frame_.data());
+                    float* ola = ola_[(size_t)ch].data();
+                    for (int i = 0; i < frameSize_; ++i)
+                        ola[i] += frame_[(size_t)i] * window_[(size_t)i] * olaGain_;
+                }
+                prevStart_ = startAt;
+            }
+            else
+            {
+                // Frames at a and a + hop packed as one complex FFT (x1 + i x2);
+                // the phase advance between them over one hop drives the synthesis phase.
+                const int n = frameSize_;
+                const int bins = n / 2 + 1;
+                for (int ch = 0; ch < chans; ++ch)
+                {
+                    readClamped(src, ch, nominal, n, re_.data());
+                    readClamped(src, ch, nominal + hop_, n, im_.data());
+                    for (int i = 0; i < n; ++i) { re_[(size_t)i] *= window_[(size_t)i]; im_[(size_t)i] *= window_[(size_t)i]; }
+                    fft_.perform(re_.data(), im_.data());
+
+                    float* ur = phasorRe_[(size_t)ch].data();
+                    float* ui = phasorIm_[(size_t)ch].data();
+                    float* yr = frame_.data();                      // reuse as spectrum scratch
+                    float* yi = monoSearch_.data();
+                    for (int k = 0; k < bins; ++k)
+                    {
+                        const int m = (n - k) & (n - 1);
+                        // X1 = (Z[k] + conj Z[n-k]) / 2,  X2 = (Z[k] - conj Z[n-k]) / 2i
+                        const float x1r = 0.5f * (re_[(size_t)k] + re_[(size_t)m]);
+                        const float x1i = 0.5f * (im_[(size_t)k] - im_[(size_t)m]);
+                        const float x2r = 0.5f * (im_[(size_t)k] + im_[(size_t)m]);
+                        const float x2i = -0.5f * (re_[(size_t)k] - re_[(size_t)m]);
+                        const float mag = std::sqrt(x1r * x1r + x1i * x1i);
+
+                        if (firstFrame_ && mag > 1.0e-12f) { ur[k] = x1r / mag; ui[k] = x1i / mag; }
+
+                        yr[k] = mag * ur[k];
+                        yi[k] = mag * ui[k];
+
+                        // advance the phasor by arg(X2 * conj X1)
+                        const float dr = x2r * x1r + x2i * x1i;
+                        const float di = x2i * x1r - x2r * x1i;
+                        const float dm = std::sqrt(dr * dr + di * di);
+                        if (dm > 1.0e-20f)
+                        {
+                            const float nr = (ur[k] * dr - ui[k] * di) / dm;
+                            const float ni = (ur[k] * di + ui[k] * dr) / dm;
+                            ur[k] = nr; ui[k] = ni;
+                        }
+                    }
+
+                    // Hermitian fill, inverse, synthesis window, overlap-add
+                    for (int k = 0; k < bins; ++k) { re_[(size_t)k] = yr[k]; im_[(size_t)k] = yi[k]; }
+                    for (int k = bins; k < n; ++k) { re_[(size_t)k] = yr[n - k]; im_[(size_t)k] = -yi[n - k]; }
+                    fft_.performInverse(re_.data(), im_.data());
+
+                    float* ola = ola_[(size_t)ch].data();
+                    for (int i = 0; i < n; ++i)
+                        ola[i] += re_[(size_t)i] * window_[(size_t)i] * olaGain_;
+                }
+            }
+
+            firstFrame_ = false;
+            analysisPos_ += (int64_t)hop_ * PlayheadPhase::step(speed);
+
+            // the first hop of the overlap is complete: move it to the fifo and shift
+            for (int ch = 0; ch < chans; ++ch)
+            {
+                float* ola = ola_[(size_t)ch].data();
+                std::memcpy(fifo_[(size_t)ch].data() + fifoCount_, ola, sizeof(float) * (size_t)hop_);
+                std::memmove(ola, ola + hop_, sizeof(float) * (size_t)(frameSize_ - hop_));
+                std::fill(ola + frameSize_ - hop_, ola + frameSize_, 0.0f);
+            }
+            fifoCount_ += hop_;
+        }
+
+        void popFifo(int n) noexcept
+        {
+            fifoCount_ -= n;
+            for (auto& f : fifo_)
+                std::memmove(f.data(), f.data() + n, sizeof(float) * (size_t)fifoCount_);
+        }
+
+        dsp::Fft fft_;
+        Mode mode_ = off;
+        int numChannels_ = 0;
+        int maxBlock_ = 1;
+        int frameSize_ = kWsolaFrame;
+        int hop_ = kWsolaFrame / 4;
+        int fifoCount_ = 0;
+        bool firstFrame_ = true;
+        long long prevStart_ = 0;
+        PlayheadPhase analysisPos_;
+        PlayheadPhase position_;
+        float olaGain_ = 1.0f;
+
+        std::vector<std::vector<float>> ola_, fifo_, phasorRe_, phasorIm_;
+        std::vector<float> frame_, re_, im_, monoRef_, monoSearch_, window_;
+    };
+
+} // namespace ttvst
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    LoadGovernor.h
+    Steps rendering quality down when the audio thread runs out of headroom.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace ttvst {
+
+    // One change of level, as the audio thread saw it
+    struct GovernorEvent
+    {
+        int64_t time = 0;       // absolute sample time of the block that changed level
+        int     from = 0, to = 0;
+        float   load = 0.0f;    // smoothed load that triggered it, 1.0 = the whole block budget
+    };
+
+    /**
+     * Measures processBlock the way juce::AudioProcessLoadMeasurer does (render time over
+     * the real-time length of the block, smoothed) and maps it to a degradation level:
+     * - one level down once the load has stayed above the limit for kDownBlocks blocks;
+     *   the next step waits kSettleSeconds so the cheaper level shows in the measurement
+     * - one level up only after the load has stayed under half the limit for kUpSeconds
+     * The load is this instance's own share of the budget, not the host's total, so the
+     * limit sits well below 1. Every transition is counted and queued for the message
+     * thread (drainTo); nothing here blocks or allocates on the audio thread.
+     */
+    class LoadGovernor
+    {
+    public:
+        enum Level : int
+        {
+            full = 0,
+            sparseTelemetry,    // scope and signal tap every kSparseEvery-th block: nothing audible goes first
+            hermiteInterp,      // sinc reader capped to Hermite
+            linearInterp,       // capped to linear
+            linearKnots,        // pitch-wheel knots joined by straight lines, no spline solve
+            kNumLevels
+        };
+
+        static constexpr int kDownBlocks = 3;
+        static constexpr double kSettleSeconds = 0.1;
+        static constexpr double kUpSeconds = 2.0;
+        static constexpr int kSparseEvery = 4;
+
+        // Message thread, from prepareToPlay
+        void prepare(double sampleRate, int blockSize)
+        {
+            measurer_.reset(sampleRate, blockSize);
+            sampleRate_ = sampleRate;
+            level_ = full;
+            publishedLevel_.store(full, std::memory_order_relaxed);
+            overBlocks_ = 0;
+            underSamples_ = settleSamples_ = 0;
+        }
+
+        // Wrap processBlock in a juce::AudioProcessLoadMeasurer::ScopedTimer on this
+        juce::AudioProcessLoadMeasurer& getMeasurer() noexcept { return measurer_; }
+
+        // Any thread. Off holds the level at full.
+        void setEnabled(bool shouldBeEnabled) noexcept { enabled_.store(shouldBeEnabled, std::memory_order_relaxed); }
+        bool isEnabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+        // Any thread. Proportion of the block budget this instance may use (0.05..1)
+        void setLoadLimit(double proportion) noexcept { limit_.store(juce::jlimit(0.05, 1.0, proportion), std::memory_order_relaxed); }
+        double getLoadLimit() const noexcept { return limit_.load(std::memory_order_relaxed); }
+
+        int getLevel() const noexcept { return publishedLevel_.load(std::memory_order_relaxed); }
+        double getLoad() const noexcept { return measurer_.getLoadAsProportion(); }
+        int getNumTransitions() const noexcept { return transitions_.load(std::memory_order_relaxed); }
+
+        // Audio thread, once per block before rendering. Returns the level to render it at.
+        int update(int64_t time, int numSamples) noexcept
+        {
+            const double load = measurer_.getLoadAsProportion();
+            const double limit = limit_.load(std::memory_order_relaxed);
+            int target = level_;
+
+            if (!enabled_.load(std::memory_order_relaxed)) {
+                target = full;
+            }
+            else {
+                settleSamples_ = juce::jmax(0, settleSamples_ - numSamples);
+                overBlocks_ = load > limit ? overBlocks_ + 1 : 0;
+                const int upSamples = (int)(kUpSeconds * sampleRate_);
+                underSamples_ = load < 0.5 * limit ? juce::jmin(underSamples_ + numSamples, upSamples) : 0;
+
+                if (overBlocks_ >= kDownBlocks && settleSamples_ == 0 && level_ < kNumLevels - 1)
+                    target = level_ + 1;
+                else if (underSamples_ >= upSamples && level_ > full)
+                    target = level_ - 1;
+            }
+
+            if (target != level_) {
+                log({ time, level_, target, (float)load });
+                level_ = target;
+                publishedLevel_.store(target, std::memory_order_relaxed);
+                overBlocks_ = 0;
+                underSamples_ = 0;
+                settleSamples_ = (int)(kSettleSeconds * sampleRate_);
+            }
+            return level_;
+        }
+
+        // Message thread (editor timer)
+        void drainTo(std::vector<GovernorEvent>& out)
+        {
+            auto r = read_.load(std::memory_order_relaxed);
+            const auto w = write_.load(std::memory_order_acquire);
+            while (r != w) {
+                out.push_back(events_[r]);
+                r = (r + 1) & (kLogSize - 1);
+            }
+            read_.store(r, std::memory_order_release);
+        }
+
+        static const char* getLevelName(int level) noexcept
+        {
+            static const char* const names[kNumLevels] = { "full", "sparse telemetry", "hermite", "linear", "linear knots" };
+            return juce::isPositiveAndBelow(level, (int)kNumLevels) ? names[level] : "?";
+        }
+
+    private:
+        static constexpr size_t kLogSize = 64;   // power-of-two
+
+        void log(const GovernorEvent& e) noexcept
+        {
+            transitions_.fetch_add(1, std::memory_order_relaxed);
+            const auto w = write_.load(std::memory_order_relaxed);
+            const auto next = (w + 1) & (kLogSize - 1);
+            if (next == read_.load(std::memory_order_acquire)) return;   // nobody reading: the count still moves
+            events_[w] = e;
+            write_.store(next, std::memory_order_release);
+        }
+
+        juce::AudioProcessLoadMeasurer measurer_;
+        double sampleRate_ = 44100.0;
+        std::atomic<bool> enabled_{ true };
+        std::atomic<double> limit_{ 0.5 };
+
+        // audio thread
+        int level_ = full;
+        int overBlocks_ = 0;
+        int underSamples_ = 0;
+        int settleSamples_ = 0;
+
+        std::atomic<int> publishedLevel_{ full };
+        std::atomic<int> transitions_{ 0 };
+        std::array<GovernorEvent, kLogSize> events_{};
+        std::atomic<size_t> write_{ 0 };
+        std::atomic<size_t> read_{ 0 };
+    };
+
+} // namespace ttvst
@@ -4,6 +4,12 @@
 // If you use the Unity build, this can be just <JuceHeader.h>.
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include "SampleCodec.h"
+#include "ChunkStream.h"
 
 /**
  * LoadedAudio
@@ -11,6 +17,18 @@
  * Immutable container for fully-decoded audio held in RAM.
  * - sampleRate: Hz of the decoded buffer
  * - buffer: interleaved-by-channel, non-owning to the outside (we don't expose non-const access)
+ * - packed: the same audio in a 16-bit format when storage is int16/float16 (buffer is empty then)
+ * - frames: the same audio as interleaved float frames when storage is float32Frames,
+ *   which is never chosen for the user (see SampleStorage::float32Frames for when it pays)
+ * - stream: the file itself when storage is streamed; samples come from its chunk cache,
+ *   and a reversed copy is a second view of the same stream
+ *
+ * Every channel carries kGuard zero samples before index 0 and after the last sample,
+ * so interpolators can read a few taps past either end without bounds checks.
+ * Indices in the accessors below are track indices; [-kGuard, numSamples + kGuard) is readable.
+ *
+ * A float32 track may be published while the loader is still filling it (progressive
+ * load): the part not decoded yet reads as silence, getDecodedRange says where audio is.
  *
  * Intended to be shared across threads via std::shared_ptr<const LoadedAudio>.
  */
@@ -19,36 +37,261 @@ struct LoadedAudio
     /// Construct an empty/invalid container.
     LoadedAudio() = default;
 
-    /// Construct from a buffer copy and its sample rate.
+    /// Construct from unpadded audio and its sample rate; the guards are added here.
     LoadedAudio(double sr, const juce::AudioBuffer<float>& src)
-        : sampleRate(sr), buffer(src) {
+        : sampleRate(sr)
+    {
+        allocate(src.getNumChannels(), src.getNumSamples());
+        for (int ch = 0; ch < src.getNumChannels(); ++ch)
+            buffer.copyFrom(ch, kGuard, src, ch, 0, src.getNumSamples());
+    }
+
+    using SampleStorage = ttvst::codec::SampleStorage;
+
+    /// Zero samples kept on each side of every channel (widest interpolation kernel / 2 and then some).
+    static constexpr int kGuard = 16;
+
+    /// Size the float buffer for numCh x n track samples plus guards, all zeroed.
+    /// Loader thread only, before the object is published.
+    void allocate(int numCh, int n)
+    {
+        buffer.setSize(numCh, n + 2 * kGuard, false, true, false);
+        buffer.clear();
+        numSamples = n;
+        storage = SampleStorage::float32;
+        packed.clear();
+        frames.clear();
+    }
+
+    /// Track sample 0 of a float32 channel; valid from [-kGuard] to [numSamples + kGuard - 1].
+    const float* getReadPointer(int ch) const noexcept { return buffer.getReadPointer(ch) + kGuard; }
+    float* getWritePointer(int ch) noexcept { return buffer.getWritePointer(ch) + kGuard; }
+
+    /// Frame of track sample 0 when storage is float32Frames: getFrameStride() floats per
+    /// frame, 16-byte aligned, guard frames on both sides like the planar buffer.
+    const float* getFramePointer() const noexcept { return frames.data() + frameOffset + kGuard * frameStride; }
+    int getFrameStride() const noexcept { return frameStride; }
+
+    /// [from, to) plus [0, wrapTo) when the loader has wrapped round to the start.
+    struct DecodedRange
+    {
+        int from = 0, to = 0, wrapTo = 0;
+
+        // Track samples only: the guards read as zero either way
+        bool contains(int64_t i) const noexcept { return (i >= from && i < to) || (i >= 0 && i < wrapTo); }
+    };
+
+    /// Audio thread: the part of a progressive load decoded so far (the whole track once it
+    /// is complete). The loader reads from decodeStart to the end and wraps round to it;
+    /// a reversed copy fills from decodeStart downwards, mirroring the forward one.
+    /// Edges facing samples not decoded yet are pulled in by kGuard, so an interpolator's
+    /// taps at the edge never reach memory the loader may be writing.
+    DecodedRange getDecodedRange() const noexcept
+    {
+        const int d = numSamples - framesPending.load(std::memory_order_acquire);
+        if (d >= numSamples) return { 0, numSamples, 0 };
+
+        int from = decodeDownward ? decodeStart - d : decodeStart;
+        if (from < 0) from += numSamples;
+        const int end = from + d;
+        DecodedRange r = end <= numSamples ? DecodedRange{ from, end, 0 } : DecodedRange{ from, numSamples, end - numSamples };
+
+        if (r.from > 0) r.from += kGuard;
+        if (r.wrapTo > 0) r.wrapTo = std::max(0, r.wrapTo - kGuard);
+        else if (r.to < numSamples) r.to -= kGuard;
+        r.to = std::max(r.to, r.from);
+        return r;
     }
 
-    /// Move-enabled for efficiency.
-    LoadedAudio(double sr, juce::AudioBuffer<float>&& src)
-        : sampleRate(sr), buffer(std::move(src)) {
+    bool isComplete() const noexcept { return framesPending.load(std::memory_order_acquire) == 0; }
+    double getDecodedProportion() const noexcept
+    {
+        return numSamples > 0 ? 1.0 - (double)framesPending.load(std::memory_order_relaxed) / numSamples : 1.0;
     }
 
     /// True if there is audio data available.
-    bool isValid() const noexcept { return buffer.getNumSamples() > 0 && sampleRate > 0.0; }
+    bool isValid() const noexcept { return getNumSamples() > 0 && sampleRate > 0.0; }
 
     /// Number of channels in the buffer.
-    int getNumChannels() const noexcept { return buffer.getNumChannels(); }
+    int getNumChannels() const noexcept
+    {
+        switch (storage)
+        {
+        case SampleStorage::float32:       return buffer.getNumChannels();
+        case SampleStorage::float32Frames: return frameChannels;
+        case SampleStorage::streamed:      return stream->getNumChannels();
+        default:                           return (int)packed.size();
+        }
+    }
 
     /// Number of samples per channel.
-    int getNumSamples() const noexcept { return buffer.getNumSamples(); }
+    int getNumSamples() const noexcept { return numSamples; }
 
     /// Length in seconds.
     double getLengthSeconds() const noexcept
     {
-        return (sampleRate > 0.0) ? static_cast<double>(buffer.getNumSamples()) / sampleRate : 0.0;
+        return (sampleRate > 0.0) ? static_cast<double>(getNumSamples()) / sampleRate : 0.0;
+    }
+
+    /// Bytes of sample data held in RAM, guards included.
+    size_t getMemoryBytes() const noexcept
+    {
+        if (storage == SampleStorage::float32Frames)
+            return sizeof(float) * frames.size();   // padding lanes included, they are resident too
+        if (storage == SampleStorage::streamed)
+            return streamReversed ? 0 : stream->getCacheBytes();   // the forward view counts the shared cache
+        return (size_t)getNumChannels() * (size_t)(getNumSamples() + 2 * kGuard) * (size_t)ttvst::codec::bytesPerSample(storage);
+    }
+
+    /// Calls fn(const void* data, size_t bytes) for each channel's storage, guards included.
+    template <typename Fn>
+    void forEachRegion(Fn&& fn) const
+    {
+        if (storage == SampleStorage::float32)
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                fn(static_cast<const void*>(buffer.getReadPointer(ch)), sizeof(float) * (size_t)buffer.getNumSamples());
+        else if (storage == SampleStorage::float32Frames)
+            fn(static_cast<const void*>(frames.data()), sizeof(float) * frames.size());
+        else if (storage == SampleStorage::streamed)
+            stream->forEachRegion(fn);
+        else
+            for (const auto& channel : packed)
+                fn(static_cast<const void*>(channel.data()), sizeof(uint16_t) * channel.size());
+    }
+
+    /// One sample as float, any storage. Fine for odd reads, use readSpan for runs.
+    /// index may reach kGuard samples past either end (reads zero there).
+    float getSample(int ch, int index) const noexcept
+    {
+        const size_t i = (size_t)(index + kGuard);
+        switch (storage)
+        {
+        case SampleStorage::int16:   return (float)(int16_t)packed[(size_t)ch][i] * ttvst::codec::kInt16Scale;
+        case SampleStorage::float16: return ttvst::codec::halfToFloat(packed[(size_t)ch][i]);
+        case SampleStorage::float32Frames: return frames[(size_t)frameOffset + i * (size_t)frameStride + (size_t)ch];
+        case SampleStorage::streamed: return stream->getSample(ch, streamReversed ? numSamples - 1 - index : index);
+        default:                     return buffer.getSample(ch, (int)i);
+        }
+    }
+
+    /// Widen [start, start + n) of one channel into dest. Vectorized for the compact formats.
+    /// The range may extend up to kGuard samples past either end of the track.
+    void readSpan(int ch, int start, int n, float* dest) const noexcept
+    {
+        const size_t from = (size_t)(start + kGuard);
+        switch (storage)
+        {
+        case SampleStorage::int16:
+            ttvst::codec::decodeInt16(reinterpret_cast<const int16_t*>(packed[(size_t)ch].data()) + from, dest, n);
+            break;
+        case SampleStorage::float16:
+            ttvst::codec::decodeHalf(packed[(size_t)ch].data() + from, dest, n);
+            break;
+        case SampleStorage::float32Frames:
+        {
+            const float* f = frames.data() + frameOffset + from * (size_t)frameStride + (size_t)ch;
+            for (int i = 0; i < n; ++i)
+                dest[i] = f[(size_t)i * (size_t)frameStride];
+            break;
+        }
+        case SampleStorage::streamed:
+            if (streamReversed) {
+                stream->readSpan(ch, numSamples - start - n, n, dest);
+                std::reverse(dest, dest + n);
+            }
+            else {
+                stream->readSpan(ch, start, n, dest);
+            }
+            break;
+        default:
+            std::memcpy(dest, buffer.getReadPointer(ch, (int)from), sizeof(float) * (size_t)n);
+            break;
+        }
+    }
+
+    /// Re-encode float32 audio into a compact storage or interleaved frames and release
+    /// the planar buffer. Tracks over 4 channels stay planar whatever the target.
+    /// Loader thread only, before the object is published.
+    void convertStorage(SampleStorage target)
+    {
+        if (target == storage || storage != SampleStorage::float32) return;
+        if (target == SampleStorage::float32Frames) {
+            interleaveFrames();
+            return;
+        }
+
+        // guards included, they encode to zero in both formats
+        const int numCh = buffer.getNumChannels();
+        const int n = buffer.getNumSamples();
+        packed.assign((size_t)numCh, std::vector<uint16_t>((size_t)n));
+
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            if (target == SampleStorage::int16)
+                ttvst::codec::encodeInt16(buffer.getReadPointer(ch), reinterpret_cast<int16_t*>(packed[(size_t)ch].data()), n);
+            else
+                ttvst::codec::encodeHalf(buffer.getReadPointer(ch), packed[(size_t)ch].data(), n);
+        }
+
+        storage = target;
+        buffer.setSize(0, 0);
+    }
+
+    /// Stereo pairs or quads, so a tap of every channel is one 8- or 16-byte read
+    void interleaveFrames()
+    {
+        const int numCh = buffer.getNumChannels();
+        if (numCh < 1 || numCh > 4) return;
+
+        const int n = buffer.getNumSamples();   // guards included
+        frameStride = numCh <= 2 ? 2 : 4;
+        frameChannels = numCh;
+        frames.assign((size_t)frameStride * (size_t)n + 3, 0.0f);   // + slack to align frame 0 on 16 bytes
+        frameOffset = (int)((4 - (reinterpret_cast<uintptr_t>(frames.data()) / sizeof(float)) % 4) % 4);
+
+        float* dst = frames.data() + frameOffset;
+        for (int ch = 0; ch < numCh; ++ch) {
+            const float* src = buffer.getReadPointer(ch);
+            for (int i = 0; i < n; ++i)
+                dst[(size_t)i * (size_t)frameStride + (size_t)ch] = src[i];
+        }
+
+        storage = SampleStorage::float32Frames;
+        buffer.setSize(0, 0);
     }
 
     /// Sample rate (Hz) of this audio.
     double sampleRate = 0.0;
 
-    /// The decoded audio data. Keep this const to encourage read-only use.
+    /// The decoded audio data, kGuard zeros on each side. Keep this const to encourage read-only use.
     juce::AudioBuffer<float> buffer;
+
+    /// How the samples are held; float32 uses `buffer`, the others `packed`.
+    SampleStorage storage = SampleStorage::float32;
+
+    /// Planar 16-bit channels (int16 bit patterns or IEEE half), only for compact storage. Guarded like buffer.
+    std::vector<std::vector<uint16_t>> packed;
+
+    /// Interleaved float frames, only for float32Frames storage. Guarded like buffer;
+    /// the first frame starts frameOffset floats in. Padding lanes of a frame are zero.
+    std::vector<float> frames;
+    int frameStride = 0, frameOffset = 0, frameChannels = 0;
+
+    /// Disk-backed samples, only for streamed storage; shared by the forward and reversed views.
+    std::shared_ptr<ttvst::ChunkStream> stream;
+    bool streamReversed = false;
+
+    /// Track samples per channel, guards excluded.
+    int numSamples = 0;
+
+    /// Progressive loads only: samples the loader has still to write, counting down to 0
+    /// (release after each chunk), and where it started. Published complete otherwise.
+    std::atomic<int> framesPending{ 0 };
+    int decodeStart = 0;
+    bool decodeDownward = false;
+
+    /// Link in TrackReclaimer's overflow list once retired; nothing else touches it.
+    mutable const LoadedAudio* retiredNext = nullptr;
 };
 
 // Handy alias for the shared, read-only handle you pass around the processor/engine.
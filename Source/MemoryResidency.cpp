@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    MemoryResidency.cpp
+
+  ==============================================================================
+*/
+
+#include "MemoryResidency.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment(lib, "psapi.lib")
+#else
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace ttvst::mem {
+
+    namespace {
+
+        size_t pageSize() noexcept
+        {
+           #if JUCE_WINDOWS
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return (size_t)info.dwPageSize;
+           #else
+            return (size_t)sysconf(_SC_PAGESIZE);
+           #endif
+        }
+
+        // [p, p + bytes) widened to whole pages
+        struct PageRange
+        {
+            char*  base = nullptr;
+            size_t bytes = 0;
+            size_t pages = 0;
+        };
+
+        PageRange pagesOf(const void* p, size_t bytes) noexcept
+        {
+            const size_t page = pageSize();
+            const auto begin = reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(page - 1);
+            const auto end = (reinterpret_cast<uintptr_t>(p) + bytes + page - 1) & ~(uintptr_t)(page - 1);
+            return { reinterpret_cast<char*>(begin), (size_t)(end - begin), (size_t)(end - begin) / page };
+        }
+
+        // [p, p + bytes) narrowed to the pages it covers whole. Heap buffers share their
+        // edge pages with neighbours, possibly another locked track: those stay locked.
+        PageRange innerPagesOf(const void* p, size_t bytes) noexcept
+        {
+            const size_t page = pageSize();
+            const auto begin = (reinterpret_cast<uintptr_t>(p) + page - 1) & ~(uintptr_t)(page - 1);
+            const auto end = (reinterpret_cast<uintptr_t>(p) + bytes) & ~(uintptr_t)(page - 1);
+            if (end <= begin) return {};
+            return { reinterpret_cast<char*>(begin), (size_t)(end - begin), (size_t)(end - begin) / page };
+        }
+
+    } // namespace
+
+    void prefault(const LoadedAudio& audio) noexcept
+    {
+        const size_t page = pageSize();
+        audio.forEachRegion([page](const void* p, size_t bytes) {
+            if (bytes == 0) return;
+           #if JUCE_LINUX && defined(MADV_HUGEPAGE)
+            const auto r = pagesOf(p, bytes);
+            madvise(r.base, r.bytes, MADV_HUGEPAGE);
+           #endif
+            const volatile char* c = static_cast<const volatile char*>(p);
+            char sink = 0;
+            for (size_t off = 0; off < bytes; off += page)
+                sink ^= c[off];
+            sink ^= c[bytes - 1];
+            (void)sink;
+        });
+    }
+
+    bool lock(const LoadedAudio& audio) noexcept
+    {
+        bool ok = true;
+        audio.forEachRegion([&ok](const void* p, size_t bytes) {
+            if (bytes == 0) return;
+            const auto r = pagesOf(p, bytes);
+           #if JUCE_WINDOWS
+            ok = VirtualLock(r.base, r.bytes) != 0 && ok;
+           #else
+            ok = mlock(r.base, r.bytes) == 0 && ok;
+           #endif
+        });
+        return ok;
+    }
+
+    void unlock(const LoadedAudio& audio) noexcept
+    {
+        audio.forEachRegion([](const void* p, size_t bytes) {
+            const auto r = innerPagesOf(p, bytes);
+            if (r.bytes == 0) return;
+           #if JUCE_WINDOWS
+            VirtualUnlock(r.base, r.bytes);
+           #else
+            munlock(r.base, r.bytes);
+           #endif
+        });
+    }
+
+    Residency measure(const LoadedAudio& audio)
+    {
+        Residency res;
+        res.measured = true;
+        const size_t page = pageSize();
+
+        audio.forEachRegion([&](const void* p, size_t bytes) {
+            if (bytes == 0) return;
+            res.bytes += bytes;
+            const auto r = pagesOf(p, bytes);
+
+           #if JUCE_WINDOWS
+            // a few thousand evenly spread pages are plenty for a percentage
+            const size_t step = std::max<size_t>(1, r.pages / 4096);
+            std::vector<PSAPI_WORKING_SET_EX_INFORMATION> info;
+            for (size_t i = 0; i < r.pages; i += step) {
+                PSAPI_WORKING_SET_EX_INFORMATION e{};
+                e.VirtualAddress = r.base + i * page;
+                info.push_back(e);
+            }
+            if (!QueryWorkingSetEx(GetCurrentProcess(), info.data(), (DWORD)(info.size() * sizeof(info[0])))) {
+                res.measured = false;
+                return;
+            }
+            size_t valid = 0;
+            for (const auto& e : info)
+                valid += e.VirtualAttributes.Valid ? 1 : 0;
+            res.residentBytes += (size_t)((double)bytes * (double)valid / (double)info.size());
+           #else
+           #if JUCE_MAC
+            std::vector<char> vec(r.pages);
+           #else
+            std::vector<unsigned char> vec(r.pages);
+           #endif
+            if (mincore(r.base, r.bytes, vec.data()) != 0) {
+                res.measured = false;
+                return;
+            }
+            size_t resident = 0;
+            for (auto v : vec)
+                resident += (v & 1) ? 1 : 0;
+            res.residentBytes += std::min(bytes, resident * page);
+           #endif
+        });
+        return res;
+    }
+
+} // namespace ttvst::mem
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    MemoryResidency.h
+    Keeping track sample memory in RAM: pre-touch, page locking, residency queries.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include "LoadedAudio.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+ #include <xmmintrin.h>
+#endif
+
+namespace ttvst::mem {
+
+    // How much of a track's sample memory is in physical RAM right now
+    struct Residency
+    {
+        size_t bytes = 0;
+        size_t residentBytes = 0;   // estimated from a page sample on platforms without a cheap full query
+        bool   measured = false;    // false: the platform cannot tell
+        bool   locked = false;      // pinned by lock(); filled in by the owner, see TrackCache::isLocked
+    };
+
+    /**
+     * Reads one byte of every page so a paged-out or never-touched buffer faults in here,
+     * on the calling thread, and not the first time the playhead lands on it.
+     * On Linux the pages are also advised as huge-page candidates.
+     */
+    void prefault(const LoadedAudio& audio) noexcept;
+
+    // Locks the pages in RAM (mlock / VirtualLock). Fails past the process lock limit.
+    bool lock(const LoadedAudio& audio) noexcept;
+    // Unlocks only the pages the track covers whole: an edge page may hold another track
+    void unlock(const LoadedAudio& audio) noexcept;
+
+    // mincore / QueryWorkingSetEx; message thread, costs a syscall over the page range
+    Residency measure(const LoadedAudio& audio);
+
+    // Cache-line prefetch hint; never faults, a no-op where there is no intrinsic
+    inline void prefetch(const void* p) noexcept
+    {
+       #if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+       #elif defined(__GNUC__)
+        __builtin_prefetch(p);
+       #else
+        (void)p;
+       #endif
+    }
+
+} // namespace ttvst::mem
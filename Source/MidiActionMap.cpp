@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    MidiActionMap.cpp
+
+  ==============================================================================
+*/
+
+#include "MidiActionMap.h"
+
+namespace ttvst::midi {
+
+    namespace {
+
+        struct ActionName
+        {
+            const char* name;
+            Action action;
+            bool takesArgument;
+        };
+
+        const ActionName actionNames[] = {
+            { "cue",          Action::cue,         true },
+            { "cue_clear",    Action::cueClear,    true },
+            { "loop_set",     Action::loopSet,     true },
+            { "loop_clear",   Action::loopClear,   false },
+            { "motor_start",  Action::motorStart,  false },
+            { "motor_stop",   Action::motorStop,   false },
+            { "motor_toggle", Action::motorToggle, false },
+            { "reverse",      Action::reverse,     false },
+            { "brake",        Action::brake,       false },
+        };
+
+    } // namespace
+
+    int ActionMap::load(const juce::File& file, juce::StringArray* errors)
+    {
+        if (!file.existsAsFile()) {
+            clear();
+            return 0;
+        }
+        return parse(file.loadFileAsString(), errors);
+    }
+
+    void ActionMap::clear() noexcept
+    {
+        table_ = {};
+        ccLast_ = {};
+        numBindings_ = 0;
+        positionController_ = {};
+    }
+
+    int ActionMap::parse(const juce::String& text, juce::StringArray* errors)
+    {
+        clear();
+
+        juce::StringArray lines;
+        lines.addLines(text);
+        for (int n = 0; n < lines.size(); ++n) {
+            const auto line = lines[n].upToFirstOccurrenceOf("#", false, false).trim();
+            if (line.isEmpty()) continue;
+
+            auto fail = [&](const char* why) {
+                if (errors != nullptr)
+                    errors->add("line " + juce::String(n + 1) + ": " + why + " (" + line + ")");
+            };
+
+            juce::StringArray tok;
+            tok.addTokens(line, " \t", "");
+            tok.removeEmptyStrings();
+            if (tok[0] == "position") {
+                const int bank = tok[2].getIntValue(), index = tok[3].getIntValue();
+                if (tok.size() < 4 || (tok[1] != "rpn" && tok[1] != "nrpn")) { fail("expected position rpn|nrpn bank index"); continue; }
+                if (!tok[2].containsOnly("0123456789") || !tok[3].containsOnly("0123456789")
+                    || !juce::isPositiveAndBelow(bank, 128) || !juce::isPositiveAndBelow(index, 128)) {
+                    fail("bank and index are 0..127");
+                    continue;
+                }
+                positionController_.kind = tok[1] == "rpn" ? ump::ControllerId::registered : ump::ControllerId::assignable;
+                positionController_.bank = (uint8_t)bank;
+                positionController_.index = (uint8_t)index;
+                ++numBindings_;
+                continue;
+            }
+            if (tok.size() < 4) { fail("expected kind, channel, number, action"); continue; }
+
+            int kind = -1;
+            if (tok[0] == "note") kind = noteKind;
+            else if (tok[0] == "cc") kind = ccKind;
+            if (kind < 0) { fail("kind is note or cc"); continue; }
+
+            int chFrom = 0, chTo = 15;
+            if (tok[1] != "*") {
+                const int ch = tok[1].getIntValue();
+                if (!tok[1].containsOnly("0123456789") || !juce::isPositiveAndNotGreaterThan(ch - 1, 15)) {
+                    fail("channel is 1..16 or *");
+                    continue;
+                }
+                chFrom = chTo = ch - 1;
+            }
+
+            const int num = tok[2].getIntValue();
+            if (!tok[2].containsOnly("0123456789") || !juce::isPositiveAndBelow(num, 128)) {
+                fail("number is 0..127");
+                continue;
+            }
+
+            const ActionName* a = nullptr;
+            for (const auto& candidate : actionNames)
+                if (tok[3] == candidate.name) a = &candidate;
+            if (a == nullptr) { fail("unknown action"); continue; }
+
+            Binding b;
+            b.action = a->action;
+            if (a->takesArgument) {
+                if (tok.size() < 5) { fail("action needs an argument"); continue; }
+                if (a->action == Action::cue || a->action == Action::cueClear) {
+                    const int slot = tok[4].getIntValue();
+                    if (!tok[4].containsOnly("0123456789") || !juce::isPositiveAndBelow(slot, kNumHotCues)) {
+                        fail("cue slot is 0..7");
+                        continue;
+                    }
+                    b.slot = (uint8_t)slot;
+                }
+                else {
+                    b.value = tok[4].getFloatValue();
+                    if (!(b.value > 0.0f)) { fail("loop length must be positive seconds"); continue; }
+                }
+            }
+
+            for (int ch = chFrom; ch <= chTo; ++ch)
+                table_[(size_t)kind][(size_t)ch][(size_t)num] = b;
+            ++numBindings_;
+        }
+        return numBindings_;
+    }
+
+} // namespace ttvst::midi
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    MidiActionMap.h
+    Maps controller notes and CCs to transport actions, looked up per message
+    on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include "TransportCommandQueue.h"
+#include "UmpPosition.h"
+
+namespace ttvst::midi {
+
+    enum class Action : uint8_t
+    {
+        none = 0,
+        cue,            // hot cue `slot`: jump to it, or store the playhead there if empty
+        cueClear,       // empty hot cue `slot`
+        loopSet,        // loop of `value` seconds from the playhead
+        loopClear,
+        motorStart,
+        motorStop,
+        motorToggle,
+        reverse,        // toggle play direction
+        brake,          // motor spins down over the brake time, then stops
+        kNumActions
+    };
+
+    struct Binding
+    {
+        Action action = Action::none;
+        uint8_t slot = 0;
+        float value = 0.0f;
+    };
+
+    /**
+     * Fixed table indexed by message kind (note-on / CC), channel and data1; lookup is
+     * three array indices, nothing allocated, no strings. A note fires on note-on
+     * (velocity > 0); a CC fires when its value crosses 64 upwards, so both momentary
+     * and toggling pads trigger once per press.
+     * Built on the message thread (load) before the processor starts; the audio thread
+     * only reads the table and owns the CC edge state.
+     *
+     * File format, one binding per line, '#' starts a comment:
+     *     note|cc  <channel 1..16 or *>  <number 0..127>  <action> [argument]
+     * actions: cue <slot 0..7>, cue_clear <slot 0..7>, loop_set <seconds>, loop_clear, motor_start, motor_stop,
+     * motor_toggle, reverse, brake
+     * and one line naming the MIDI 2.0 controller that carries the platter position, if any
+     * (see ump::PositionDecoder):
+     *     position  rpn|nrpn  <bank 0..127>  <index 0..127>
+     */
+    class ActionMap
+    {
+    public:
+        static constexpr int kNumHotCues = 8;
+
+        // Message thread. Replaces the table; lines that do not parse are skipped and
+        // listed in `errors` if given. Returns the number of bindings set.
+        int load(const juce::File& file, juce::StringArray* errors = nullptr);
+        int parse(const juce::String& text, juce::StringArray* errors = nullptr);
+        void clear() noexcept;
+        int getNumBindings() const noexcept { return numBindings_; }
+        ump::ControllerId getPositionController() const noexcept { return positionController_; }
+
+        // Audio thread. True when m is bound and fires; c is then the command for the
+        // transport at sampleOffset.
+        bool toCommand(const juce::MidiMessage& m, int sampleOffset, TransportCommand& c) noexcept
+        {
+            const int ch = m.getChannel() - 1;
+            if (!juce::isPositiveAndBelow(ch, 16)) return false;
+
+            const Binding* b = nullptr;
+            if (m.isNoteOn()) {
+                b = &table_[noteKind][(size_t)ch][(size_t)m.getNoteNumber()];
+            }
+            else if (m.isController()) {
+                const int num = m.getControllerNumber(), v = m.getControllerValue();
+                auto& last = ccLast_[(size_t)ch][(size_t)num];
+                const bool rising = v >= 64 && last < 64;
+                last = (uint8_t)v;
+                if (rising) b = &table_[ccKind][(size_t)ch][(size_t)num];
+            }
+            if (b == nullptr || b->action == Action::none) return false;
+
+            c = {};
+            c.sampleOffset = sampleOffset;
+            switch (b->action) {
+            case Action::cue:         c.type = TransportCommand::hotCue; c.intValue = b->slot; break;
+            case Action::cueClear:    c.type = TransportCommand::clearHotCue; c.intValue = b->slot; break;
+            case Action::loopSet:     c.type = TransportCommand::loopFromPlayhead; c.position = b->value; break;
+            case Action::loopClear:   c.type = TransportCommand::setLoop; c.intValue = 0; break;
+            case Action::motorStart:  c.type = TransportCommand::setMotor; c.intValue = 1; break;
+            case Action::motorStop:   c.type = TransportCommand::setMotor; c.intValue = 0; break;
+            case Action::motorToggle: c.type = TransportCommand::toggleMotor; break;
+            case Action::reverse:     c.type = TransportCommand::toggleReverse; break;
+            case Action::brake:       c.type = TransportCommand::brake; break;
+            default:                  return false;
+            }
+            return true;
+        }
+
+    private:
+        enum { noteKind = 0, ccKind, kNumKinds };
+
+        std::array<std::array<std::array<Binding, 128>, 16>, kNumKinds> table_{};
+        std::array<std::array<uint8_t, 128>, 16> ccLast_{};
+        int numBindings_ = 0;
+        ump::ControllerId positionController_;
+    };
+
+} // namespace ttvst::midi
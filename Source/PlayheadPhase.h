@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    PlayheadPhase.h
+    Signed 32.32 fixed-point position in source samples.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace ttvst {
+
+    /**
+     * Playhead position as a 64-bit integer: 32 bits of sample index, 32 bits of fraction.
+     * Adding integer steps is exact, so a constant speed lands on the same sample after
+     * hours of playback (a double accumulator at 3e8 samples rounds every add by ~3e-8).
+     * The index is a shift and the interpolation weight a mask, no float->int conversion
+     * in the render loop. Range is +-2^31 samples (12 h at 48 kHz).
+     */
+    struct PlayheadPhase
+    {
+        static constexpr int    fracBits = 32;
+        static constexpr double unit = 4294967296.0;        // 2^32, one sample
+        static constexpr double invUnit = 1.0 / unit;
+
+        int64_t raw = 0;
+
+        static PlayheadPhase fromSamples(double samples) noexcept { return { (int64_t)std::llround(samples * unit) }; }
+        static PlayheadPhase fromIndex(int64_t index) noexcept { return { index * ((int64_t)1 << fracBits) }; }
+
+        // Per-sample increment for a playback ratio (source samples per output sample)
+        static int64_t step(double ratio) noexcept { return (int64_t)std::llround(ratio * unit); }
+
+        static constexpr PlayheadPhase lowest() noexcept { return { std::numeric_limits<int64_t>::min() }; }
+        static constexpr PlayheadPhase highest() noexcept { return { std::numeric_limits<int64_t>::max() }; }
+
+        double toSamples() const noexcept { return (double)raw * invUnit; }
+
+        // floor(position); relies on arithmetic right shift of negative values (every target we build for)
+        int64_t index() const noexcept { return raw >> fracBits; }
+
+        // position - index(), in [0, 1)
+        template <typename FloatType>
+        FloatType frac() const noexcept { return (FloatType)(uint32_t)raw * (FloatType)invUnit; }
+
+        PlayheadPhase& operator+= (int64_t s) noexcept { raw += s; return *this; }
+
+        bool operator<  (PlayheadPhase o) const noexcept { return raw <  o.raw; }
+        bool operator>= (PlayheadPhase o) const noexcept { return raw >= o.raw; }
+    };
+
+} // namespace ttvst
@@ -33,7 +33,7 @@ PluginTestowy2AudioProcessorEditor::PluginTestowy2AudioProcessorEditor (PluginTe
                 {
                     auto file = fc.getResult();
                     if (file.existsAsFile())
-                        audioProcessor.beginLoadFile(file); // Twj stub/loader
+                        audioProcessor.beginLoadFile(file, deckSelector.getSelectedItemIndex()); // Twj stub/loader
 
                     fileChooser.reset(); // posprztaj po dialogu
                 });
@@ -49,6 +49,204 @@ PluginTestowy2AudioProcessorEditor::PluginTestowy2AudioProcessorEditor (PluginTe
        audioProcessor.setMotorState(motorStateButton.getToggleState());
     };
 
+    addAndMakeVisible(loopButton);
+    loopButton.setToggleState(true, juce::dontSendNotification); // matches processor default
+    loopButton.onClick = [this]() {
+        audioProcessor.setLoopState(loopButton.getToggleState());
+    };
+
+    addAndMakeVisible(deckSelector);
+    for (int d = 0; d < PluginTestowy2AudioProcessor::kNumDecks; ++d)
+        deckSelector.addItem("deck " + juce::String(d + 1), d + 1);
+    deckSelector.setSelectedItemIndex(0, juce::dontSendNotification);
+    deckSelector.onChange = [this]() {
+        audioProcessor.selectDeck(deckSelector.getSelectedItemIndex());
+    };
+
+    addAndMakeVisible(pitchSlider);
+    pitchSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    pitchSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 60, 20);
+    pitchSlider.setRange(-8.0, 8.0, 0.01);          // percent, classic +-8 pitch fader
+    pitchSlider.setTextValueSuffix(" %");
+    pitchSlider.setDoubleClickReturnValue(true, 0.0);
+    pitchSlider.setValue((audioProcessor.getMotorSpeed() - 1.0) * 100.0, juce::dontSendNotification);
+    pitchSlider.onValueChange = [this]() {
+        audioProcessor.setMotorSpeed(1.0 + pitchSlider.getValue() / 100.0);
+    };
+
+    addAndMakeVisible(keylockSelector);
+    keylockSelector.addItem("keylock off", 1);
+    keylockSelector.addItem("keylock WSOLA", 2);
+    keylockSelector.addItem("keylock phase voc.", 3);
+    keylockSelector.setSelectedItemIndex(audioProcessor.getKeylockMode(), juce::dontSendNotification);
+    keylockSelector.onChange = [this]() {
+        audioProcessor.setKeylockMode(keylockSelector.getSelectedItemIndex());
+    };
+
+    addAndMakeVisible(samplerSelector);
+    samplerSelector.addItem("pads off", ttvst::sampler::off + 1);
+    samplerSelector.addItem("pads one-shot", ttvst::sampler::oneShot + 1);
+    samplerSelector.addItem("pads gated", ttvst::sampler::gated + 1);
+    samplerSelector.setSelectedId(audioProcessor.getSamplerMode() + 1, juce::dontSendNotification);
+    samplerSelector.onChange = [this]() {
+        audioProcessor.setSamplerMode(samplerSelector.getSelectedId() - 1);
+    };
+
+    addAndMakeVisible(loopInButton);
+    loopInButton.onClick = [this]() {
+        loopInPoint = audioProcessor.getPlayheadPosition();
+    };
+
+    addAndMakeVisible(loopOutButton);
+    loopOutButton.onClick = [this]() {
+        const double out = audioProcessor.getPlayheadPosition();
+        if (out <= loopInPoint) return;
+        audioProcessor.setLoopRegion(loopInPoint, (int)std::round(out - loopInPoint));
+        audioProcessor.setLoopState(true);
+        loopButton.setToggleState(true, juce::dontSendNotification);
+    };
+
+    addAndMakeVisible(tapButton);
+    tapButton.onClick = [this]() {
+        if (!tapButton.getToggleState()) {
+            audioProcessor.stopSignalTap();
+            return;
+        }
+        const auto dir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("ttvst taps");
+        dir.createDirectory();
+        const auto file = dir.getChildFile("tap " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".ttap");
+        if (!audioProcessor.startSignalTap(file))
+            tapButton.setToggleState(false, juce::dontSendNotification);
+    };
+
+    addAndMakeVisible(recFormatSelector);
+    recFormatSelector.addItem("WAV", (int)ttvst::SetRecorder::Format::wav + 1);
+    recFormatSelector.addItem("FLAC", (int)ttvst::SetRecorder::Format::flac + 1);
+    recFormatSelector.setSelectedId((int)ttvst::SetRecorder::Format::flac + 1, juce::dontSendNotification);
+    addAndMakeVisible(recButton);
+    recButton.setToggleState(audioProcessor.getSetRecorder().isRecording(), juce::dontSendNotification);
+    recButton.onClick = [this]() {
+        if (!recButton.getToggleState()) {
+            audioProcessor.stopSetRecording();
+            recButton.setButtonText("rec");
+            return;
+        }
+        const auto dir = juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("ttvst sets");
+        const auto format = (ttvst::SetRecorder::Format)(recFormatSelector.getSelectedId() - 1);
+        if (!audioProcessor.startSetRecording(dir, format))
+            recButton.setToggleState(false, juce::dontSendNotification);
+    };
+
+    addAndMakeVisible(sourceSelector);
+    sourceSelector.addItem("platter: pitch wheel / MIDI 2.0", PluginTestowy2AudioProcessor::pitchWheelSource + 1);
+    sourceSelector.addItem("platter: timecode in", PluginTestowy2AudioProcessor::timecodeSource + 1);
+    sourceSelector.setSelectedId(audioProcessor.getPositionSource() + 1, juce::dontSendNotification);
+    sourceSelector.onChange = [this]() {
+        audioProcessor.setPositionSource(sourceSelector.getSelectedId() - 1);
+    };
+    addAndMakeVisible(timecodeLabel);
+
+    addAndMakeVisible(scratchWindowSelector);
+    for (int b = 1; b <= PluginTestowy2AudioProcessor::kMaxScratchWindow; ++b)
+        scratchWindowSelector.addItem("scratch lookahead: " + juce::String(b) + (b == 1 ? " block" : " blocks"), b);
+    scratchWindowSelector.setSelectedId(audioProcessor.getScratchWindow(), juce::dontSendNotification);
+    scratchWindowSelector.onChange = [this]() {
+        audioProcessor.setScratchWindow(scratchWindowSelector.getSelectedId());
+    };
+
+    addAndMakeVisible(interpSelector);
+    interpSelector.addItem("interpolation: linear", ttvst::interp::linear + 1);
+    interpSelector.addItem("interpolation: hermite", ttvst::interp::hermite + 1);
+    interpSelector.addItem("interpolation: sinc", ttvst::interp::sinc + 1);
+    interpSelector.setSelectedId(audioProcessor.getInterpolation() + 1, juce::dontSendNotification);
+    interpSelector.onChange = [this]() {
+        audioProcessor.setInterpolation(interpSelector.getSelectedId() - 1);
+    };
+
+    addAndMakeVisible(governorButton);
+    governorButton.setToggleState(audioProcessor.getGovernor().isEnabled(), juce::dontSendNotification);
+    governorButton.onClick = [this]() {
+        audioProcessor.getGovernor().setEnabled(governorButton.getToggleState());
+    };
+
+    addAndMakeVisible(loadLimitSelector);
+    for (int percent : { 25, 50, 75 })
+        loadLimitSelector.addItem("cpu limit " + juce::String(percent) + " %", percent);
+    loadLimitSelector.setSelectedId((int)std::round(audioProcessor.getGovernor().getLoadLimit() * 100.0), juce::dontSendNotification);
+    loadLimitSelector.onChange = [this]() {
+        audioProcessor.getGovernor().setLoadLimit(loadLimitSelector.getSelectedId() / 100.0);
+    };
+    addAndMakeVisible(governorLabel);
+
+    for (int k = 0; k < (int)stemFaders.size(); ++k) {
+        auto& fader = stemFaders[(size_t)k];
+        addAndMakeVisible(fader);
+        fader.setSliderStyle(juce::Slider::LinearHorizontal);
+        fader.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 60, 20);
+        fader.setRange(0.0, 1.0, 0.01);
+        fader.textFromValueFunction = [k](double v) { return "S" + juce::String(k + 1) + " " + juce::String(juce::roundToInt(v * 100.0)) + "%"; };
+        fader.setDoubleClickReturnValue(true, 1.0);
+        fader.setValue(audioProcessor.getStemGain(k), juce::dontSendNotification);
+        fader.onValueChange = [this, k]() {
+            audioProcessor.setStemGain(k, (float)stemFaders[(size_t)k].getValue());
+        };
+    }
+
+    addAndMakeVisible(storageSelector);
+    storageSelector.addItem("RAM: 32-bit float", 1);
+    storageSelector.addItem("RAM: 16-bit PCM", 2);
+    storageSelector.addItem("RAM: 16-bit half", 3);
+    storageSelector.addItem("RAM: 32-bit interleaved", 4);   // 4-ch stems, sinc scratching; slower stereo at linear/Hermite
+    storageSelector.addItem("Disk: streamed", 5);            // long compressed mixes, a few MB of cache
+    storageSelector.setSelectedItemIndex((int)audioProcessor.getSampleStorage(), juce::dontSendNotification);
+    storageSelector.onChange = [this]() {
+        // takes effect for the next load
+        audioProcessor.setSampleStorage((ttvst::codec::SampleStorage)storageSelector.getSelectedItemIndex());
+    };
+
+    addAndMakeVisible(cacheBudgetSelector);
+    for (int mb : { 512, 1024, 2048, 4096 })
+        cacheBudgetSelector.addItem("cache " + juce::String(mb) + " MB", mb);
+    cacheBudgetSelector.setSelectedId((int)(audioProcessor.getTrackCache().getMemoryBudget() >> 20), juce::dontSendNotification);
+    cacheBudgetSelector.onChange = [this]() {
+        audioProcessor.getTrackCache().setMemoryBudget((size_t)cacheBudgetSelector.getSelectedId() << 20);
+    };
+
+    addAndMakeVisible(lockMemoryButton);
+    lockMemoryButton.setToggleState(audioProcessor.getLockSampleMemory(), juce::dontSendNotification);
+    lockMemoryButton.onClick = [this]() {
+        audioProcessor.setLockSampleMemory(lockMemoryButton.getToggleState());
+        residencyCountdown = 0;
+    };
+
+    addAndMakeVisible(crateButton);
+    crateButton.onClick = [this]() {
+        fileChooser = std::make_unique<juce::FileChooser>(
+            "Add tracks to the crate...", juce::File{},
+            "*.wav;*.aiff;*.flac;*.mp3"
+        );
+
+        auto flags = juce::FileBrowserComponent::openMode
+            | juce::FileBrowserComponent::canSelectFiles
+            | juce::FileBrowserComponent::canSelectMultipleItems;
+
+        fileChooser->launchAsync(flags, [this](const juce::FileChooser& fc)
+            {
+                for (const auto& file : fc.getResults()) {
+                    if (!file.existsAsFile()) continue;
+                    crate.add(file);
+                    crateSelector.addItem(file.getFileName(), crate.size());
+                }
+                fileChooser.reset();
+            });
+    };
+
+    addAndMakeVisible(crateSelector);
+    crateSelector.setTextWhenNothingSelected("crate");
+    crateSelector.onChange = [this]() {
+        loadCrateEntry(crateSelector.getSelectedItemIndex());
+    };
+
     // MIDI monitor setup
     midiMonitor.setMultiLine(true);
     midiMonitor.setReadOnly(true);
@@ -56,12 +254,13 @@ PluginTestowy2AudioProcessorEditor::PluginTestowy2AudioProcessorEditor (PluginTe
     midiMonitor.setCaretVisible(false);
     midiMonitor.setFont(juce::FontOptions(13.0f));
     addAndMakeVisible(midiMonitor);
+    addAndMakeVisible(scopeView);
     
     startTimerHz(30); // poll MIDI log ~30 FPS
 
 
 
-    setSize (500, 400);
+    setSize (500, 632);
 }
 
 PluginTestowy2AudioProcessorEditor::~PluginTestowy2AudioProcessorEditor()
@@ -90,24 +289,118 @@ void PluginTestowy2AudioProcessorEditor::resized()
     //motorStateButton.setBounds(getLocalBounds().reduced(20));
     auto area = getLocalBounds().reduced(8);
     auto top = area.removeFromTop(36);
-    loadButton.setBounds(top.removeFromLeft(140));
-    clearLogButton.setBounds(top.removeFromLeft(280));
-    motorStateButton.setBounds(top.removeFromLeft(420));
+    loadButton.setBounds(top.removeFromLeft(110));
+    clearLogButton.setBounds(top.removeFromLeft(90));
+    motorStateButton.setBounds(top.removeFromLeft(120));
+    loopButton.setBounds(top.removeFromLeft(70));
+    deckSelector.setBounds(top.removeFromLeft(90).reduced(0, 4));
+    area.removeFromTop(4);
+    auto settings = area.removeFromTop(28);
+    storageSelector.setBounds(settings.removeFromLeft(150).reduced(0, 2));
+    cacheBudgetSelector.setBounds(settings.removeFromLeft(120).reduced(2, 2));
+    lockMemoryButton.setBounds(settings.removeFromLeft(60));
+    crateButton.setBounds(settings.removeFromLeft(90).reduced(2, 0));
+    crateSelector.setBounds(settings.reduced(0, 2));
+    area.removeFromTop(4);
+    auto pitch = area.removeFromTop(28);
+    keylockSelector.setBounds(pitch.removeFromLeft(150).reduced(0, 2));
+    loopInButton.setBounds(pitch.removeFromLeft(65).reduced(2, 0));
+    loopOutButton.setBounds(pitch.removeFromLeft(65).reduced(2, 0));
+    tapButton.setBounds(pitch.removeFromLeft(60));
+    recButton.setBounds(pitch.removeFromLeft(110));
+    recFormatSelector.setBounds(pitch.removeFromLeft(70).reduced(0, 2));
+    pitchSlider.setBounds(pitch);
+    area.removeFromTop(4);
+    auto source = area.removeFromTop(28);
+    sourceSelector.setBounds(source.removeFromLeft(180).reduced(0, 2));
+    scratchWindowSelector.setBounds(source.removeFromRight(180).reduced(0, 2));
+    samplerSelector.setBounds(source.removeFromRight(130).reduced(2, 2));
+    timecodeLabel.setBounds(source.reduced(4, 0));
+    area.removeFromTop(4);
+    auto quality = area.removeFromTop(28);
+    interpSelector.setBounds(quality.removeFromLeft(170).reduced(0, 2));
+    governorButton.setBounds(quality.removeFromLeft(60));
+    loadLimitSelector.setBounds(quality.removeFromLeft(120).reduced(0, 2));
+    governorLabel.setBounds(quality.reduced(4, 0));
+    area.removeFromTop(4);
+    const int faderWidth = area.getWidth() / kStemsPerRow;
+    for (int k = 0; k < (int)stemFaders.size(); k += kStemsPerRow) {
+        auto stemRow = area.removeFromTop(28);
+        for (int j = k; j < juce::jmin(k + kStemsPerRow, (int)stemFaders.size()); ++j)
+            stemFaders[(size_t)j].setBounds(stemRow.removeFromLeft(faderWidth));
+    }
+    area.removeFromTop(8);
+    scopeView.setBounds(area.removeFromTop(140));
     area.removeFromTop(8);
     midiMonitor.setBounds(area);
 
 }
 
+ void PluginTestowy2AudioProcessorEditor::loadCrateEntry(int index)
+ {
+    if (!juce::isPositiveAndBelow(index, crate.size())) return;
+
+    audioProcessor.beginLoadFile(crate[index], deckSelector.getSelectedItemIndex());
+
+    // decode the next few entries now, so moving down the crate is instant
+    for (int next = index + 1; next <= index + kPreloadAhead && next < crate.size(); ++next)
+        audioProcessor.preloadFile(crate[next]);
+ }
+
  void PluginTestowy2AudioProcessorEditor::timerCallback()
  {
+    if (sourceSelector.getSelectedId() - 1 == PluginTestowy2AudioProcessor::timecodeSource) {
+        const auto tc = audioProcessor.getTimecodeStatus();
+        timecodeLabel.setText(!tc.signal ? "no signal"
+            : juce::String(tc.locked ? "locked  " : "relative  ") + juce::String(tc.speed * 100.0, 1) + " %",
+            juce::dontSendNotification);
+    }
+    else if (--residencyCountdown <= 0) {
+        // mincore over the whole track: once a second is plenty
+        residencyCountdown = 30;
+        const int deck = deckSelector.getSelectedItemIndex();
+        const auto r = audioProcessor.getDeckResidency(deck);
+        const auto track = audioProcessor.getLoaded(deck);
+        const juce::String decoding = track != nullptr && !track->isComplete()
+            ? "decoding " + juce::String(100.0 * track->getDecodedProportion(), 0) + " %  " : juce::String();
+        timecodeLabel.setText(r.bytes == 0 || !r.measured ? decoding
+            : decoding + "in RAM " + juce::String(100.0 * (double)r.residentBytes / (double)r.bytes, 0) + " % of "
+                + juce::String((double)r.bytes / (1024.0 * 1024.0), 1) + " MB" + (r.locked ? ", locked" : ""),
+            juce::dontSendNotification);
+    }
+
+    // elapsed time of the set; "!" once a block was dropped or the disk refused a write
+    const auto& recorder = audioProcessor.getSetRecorder();
+    if (recorder.isRecording()) {
+        const int seconds = (int)(recorder.getRecordedSamples() / juce::jmax(1.0, audioProcessor.getSampleRate()));
+        recButton.setButtonText("rec " + juce::String(seconds / 60) + ":" + juce::String(seconds % 60).paddedLeft('0', 2)
+            + (recorder.getDroppedSamples() > 0 || recorder.hasWriteError() ? " !" : ""));
+    }
+
+    if (const auto* frame = audioProcessor.getScope().acquire())
+        scopeView.setFrame(frame);
+
+    auto& governor = audioProcessor.getGovernor();
+    governorLabel.setText("load " + juce::String(governor.getLoad() * 100.0, 0) + " %  "
+        + ttvst::LoadGovernor::getLevelName(governor.getLevel()), juce::dontSendNotification);
+
     std::vector<ttvst::MidiEvent> events;
     audioProcessor.getMidiLog().drainTo(events);
+    std::vector<ttvst::GovernorEvent> transitions;
+    governor.drainTo(transitions);
+    const uint32_t overflows = audioProcessor.getKnotOverflows();
     
-    if (events.empty()) return;
+    if (events.empty() && transitions.empty() && overflows == knotOverflowsSeen) return;
     
     // Append new lines to our fixed-size buffer
     for (const auto& e : events)
         midiLines.add(e.toString());
+    for (const auto& t : transitions)
+        midiLines.add(juce::String("governor: ") + ttvst::LoadGovernor::getLevelName(t.from) + " -> "
+            + ttvst::LoadGovernor::getLevelName(t.to) + " at load " + juce::String(t.load * 100.0f, 0) + " %");
+    if (overflows != knotOverflowsSeen)
+        midiLines.add("scratch: spline window full " + juce::String(overflows - knotOverflowsSeen) + "x, curve restarted");
+    knotOverflowsSeen = overflows;
     
     // Trim to last kMaxLines
     if (midiLines.size() > kMaxLines)
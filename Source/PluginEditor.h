@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ScopeView.h"
 
 //==============================================================================
 /**
@@ -27,12 +28,44 @@ public:
     void timerCallback() override;
 
 private:
+    void loadCrateEntry(int index);
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     PluginTestowy2AudioProcessor& audioProcessor;
     juce::TextButton loadButton{ "Load File" };
     juce::TextButton clearLogButton{ "Clear Logs" };
     juce::ToggleButton motorStateButton{ "engine start" };
+    juce::ToggleButton loopButton{ "loop" };
+    juce::ComboBox deckSelector;
+    juce::ComboBox storageSelector;
+    juce::ComboBox cacheBudgetSelector;
+    juce::ToggleButton lockMemoryButton{ "lock" };   // keep on-air tracks locked in RAM
+    juce::TextButton crateButton{ "Add to crate" };
+    juce::ComboBox crateSelector;
+    juce::Slider pitchSlider;
+    juce::ComboBox keylockSelector;
+    juce::TextButton loopInButton{ "loop in" };
+    juce::TextButton loopOutButton{ "loop out" };
+    juce::ToggleButton tapButton{ "tap" };   // signal-tap recording, see Scripts/read_tap.py
+    juce::ToggleButton recButton{ "rec" };   // the set to disk, see SetRecorder
+    juce::ComboBox recFormatSelector;
+    double loopInPoint = 0.0;   // source samples, set by loopInButton
+    juce::ComboBox sourceSelector;
+    juce::ComboBox scratchWindowSelector;
+    juce::ComboBox samplerSelector;   // notes 36-43 play the hot cues, see ttvst::sampler
+    std::array<juce::Slider, PluginTestowy2AudioProcessor::kMaxStems> stemFaders;   // every stem the processor saves
+    static constexpr int kStemsPerRow = 4;
+    juce::ComboBox interpSelector;
+    juce::ToggleButton governorButton{ "auto" };   // let the load governor step quality down
+    juce::ComboBox loadLimitSelector;
+    juce::Label governorLabel;
+    juce::Label timecodeLabel;
+    int residencyCountdown = 0;     // timer ticks until the next residency query
+    uint32_t knotOverflowsSeen = 0; // getKnotOverflows() as last logged
+    ttvst::ScopeView scopeView;
+    juce::Array<juce::File> crate;
+    static constexpr int kPreloadAhead = 3; // crate entries decoded ahead of the one loaded
     juce::TextEditor midiMonitor;
     // Keep only a fixed number of recent lines to avoid UI slowdown
     juce::StringArray midiLines;
@@ -8,23 +8,274 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include <thread>
 #include <cstring> // memcpy (gdyby bylo potrzebne w innych wariantach)
 #include <juce_audio_formats/codecs/flac/format.h>
 #include <pluginterfaces/base/ftypes.h>
 #include <wtypes.h>
 #include <cmath>
+#include <limits>
+#include <type_traits>
 #include "helpers.h"
 #include "cubicSplines.h"
 //==============================================================================
-using LoadedPair = std::pair<std::shared_ptr<LoadedAudio>, std::shared_ptr<LoadedAudio>>;
 struct Seg { int offset = 0; int value  = 0; };
 
 
+void PluginTestowy2AudioProcessor::pushTransportCommand(const ttvst::TransportCommand& c) {
+    if (!transport_.push(c))
+        DBG("transport queue full, command dropped");
+}
+
 void PluginTestowy2AudioProcessor::setMotorState(bool state) {
-    motorState = state;
-    int s = state == true ? 1 : 0;
-    DBG("state changed to: " << s );
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setMotor;
+    c.intValue = state ? 1 : 0;
+    pushTransportCommand(c);
+    DBG("state changed to: " << c.intValue );
+}
+
+void PluginTestowy2AudioProcessor::setLoopState(bool state) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setLoop;
+    c.intValue = state ? 1 : 0;
+    pushTransportCommand(c);
+}
+
+void PluginTestowy2AudioProcessor::setLoopRegion(double startSample, int lengthSamples) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setLoopRegion;
+    c.position = startSample;
+    c.intValue = lengthSamples;
+    pushTransportCommand(c);
+}
+
+double PluginTestowy2AudioProcessor::getPlayheadPosition() const noexcept {
+    return playheadSnapshot_.load(std::memory_order_relaxed);
+}
+
+void PluginTestowy2AudioProcessor::setPositionSource(int source) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setPositionSource;
+    c.intValue = source;
+    pushTransportCommand(c);
+}
+
+int PluginTestowy2AudioProcessor::getPositionSource() const noexcept {
+    return positionSourceSnapshot_.load(std::memory_order_relaxed);
+}
+
+ttvst::timecode::Decoder::Status PluginTestowy2AudioProcessor::getTimecodeStatus() const noexcept {
+    ttvst::timecode::Decoder::Status st;
+    st.signal = timecodeSignalSnapshot_.load(std::memory_order_relaxed);
+    st.locked = timecodeLockedSnapshot_.load(std::memory_order_relaxed);
+    st.speed = timecodeSpeedSnapshot_.load(std::memory_order_relaxed);
+    return st;
+}
+
+void PluginTestowy2AudioProcessor::setScratchWindow(int blocks) {
+    // picked up by the next block, which restarts the curve at the new delay
+    blocks = juce::jlimit(1, kMaxScratchWindow, blocks);
+    scratchWindow_.store(blocks);
+    if (preparedBlockSize_ > 0)
+        setLatencySamples(blocks * preparedBlockSize_);
+}
+
+int PluginTestowy2AudioProcessor::getScratchWindow() const noexcept {
+    return scratchWindow_.load();
+}
+
+void PluginTestowy2AudioProcessor::setStemGain(int stem, float gain) {
+    if (stem < 0 || stem >= kMaxStems) return;
+    stemGain_[(size_t)stem].store(juce::jlimit(0.0f, 2.0f, gain));
+}
+
+float PluginTestowy2AudioProcessor::getStemGain(int stem) const noexcept {
+    return stem >= 0 && stem < kMaxStems ? stemGain_[(size_t)stem].load() : 0.0f;
+}
+
+bool PluginTestowy2AudioProcessor::startSignalTap(const juce::File& file) {
+    return signalTap_.start(file, hostSampleRate_);
+}
+
+void PluginTestowy2AudioProcessor::stopSignalTap() {
+    signalTap_.stop();
+    if (const auto overruns = signalTap_.getOverruns())
+        DBG("stopSignalTap: " << (int)overruns << " chunks dropped");
+}
+
+bool PluginTestowy2AudioProcessor::isSignalTapRecording() const noexcept {
+    return signalTap_.isRecording();
+}
+
+bool PluginTestowy2AudioProcessor::startSetRecording(const juce::File& folder, ttvst::SetRecorder::Format format) {
+    const auto name = "set " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S");
+    return setRecorder_.start(folder, name, format, hostSampleRate_, juce::jmax(1, getMainBusNumOutputChannels()));
+}
+
+void PluginTestowy2AudioProcessor::stopSetRecording() {
+    setRecorder_.stop();
+}
+
+void PluginTestowy2AudioProcessor::setInterpolation(int kind) {
+    interpolation_.store(juce::jlimit(0, (int)ttvst::interp::kNumKinds - 1, kind));
+}
+
+int PluginTestowy2AudioProcessor::getInterpolation() const noexcept {
+    return interpolation_.load();
+}
+
+void PluginTestowy2AudioProcessor::jumpToCue(double sourcePosition, int deck) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::cueJump;
+    c.position = sourcePosition;
+    c.deck = deck;
+    pushTransportCommand(c);
+}
+
+void PluginTestowy2AudioProcessor::setMotorSpeed(double speed) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setMotorSpeed;
+    c.position = speed;
+    pushTransportCommand(c);
+}
+
+double PluginTestowy2AudioProcessor::getMotorSpeed() const noexcept {
+    return motorSpeedSnapshot_.load(std::memory_order_relaxed);
+}
+
+void PluginTestowy2AudioProcessor::setKeylockMode(int mode) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setKeylock;
+    c.intValue = mode;
+    pushTransportCommand(c);
+}
+
+int PluginTestowy2AudioProcessor::getKeylockMode() const noexcept {
+    return keylockSnapshot_.load(std::memory_order_relaxed);
+}
+
+void PluginTestowy2AudioProcessor::setSamplerMode(int mode) {
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::setSamplerMode;
+    c.intValue = mode;
+    pushTransportCommand(c);
+}
+
+int PluginTestowy2AudioProcessor::getSamplerMode() const noexcept {
+    return samplerSnapshot_.load(std::memory_order_relaxed);
+}
+
+void PluginTestowy2AudioProcessor::selectDeck(int deck) {
+    if (deck < 0 || deck >= kNumDecks) return;
+    ttvst::TransportCommand c;
+    c.type = ttvst::TransportCommand::selectDeck;
+    c.intValue = deck;
+    pushTransportCommand(c);
+}
+
+// audio thread only
+void PluginTestowy2AudioProcessor::applyTransportCommand(const ttvst::TransportCommand& c,
+    const LoadedAudio* current) noexcept {
+    switch (c.type) {
+    case ttvst::TransportCommand::setMotor:
+        motorState = c.intValue != 0;
+        brakeLeft_ = 0;
+        break;
+    case ttvst::TransportCommand::toggleMotor:
+        motorState = !motorState;
+        brakeLeft_ = 0;
+        break;
+    case ttvst::TransportCommand::brake:
+        if (motorState && brakeLeft_ == 0)
+            brakeLeft_ = brakeLength_;
+        break;
+    case ttvst::TransportCommand::toggleReverse:
+        reverse_ = !reverse_;
+        break;
+    case ttvst::TransportCommand::setLoop:
+        loop_ = c.intValue != 0;
+        break;
+    case ttvst::TransportCommand::setLoopRegion:
+        loopStart_ = (int)std::max(0.0, std::round(c.position));
+        loopLength_ = std::max(0, c.intValue);
+        break;
+    case ttvst::TransportCommand::loopFromPlayhead:
+        if (current != nullptr) {
+            loopStart_ = (int)std::max(0.0, std::round(playhead_.toSamples()));
+            loopLength_ = std::max(kMinLoop, (int)std::round(c.position * current->sampleRate));
+            loop_ = true;
+        }
+        break;
+    case ttvst::TransportCommand::cueJump:
+    case ttvst::TransportCommand::hotCue: {
+        if (c.deck >= 0 && c.deck != deck_)
+            break;   // meant for a deck no longer selected (a restore finishing after a deck change)
+        double target = c.position;
+        if (c.type == ttvst::TransportCommand::hotCue) {
+            // an empty slot takes the current position instead
+            auto& slot = hotCues_[(size_t)deck_][(size_t)juce::jlimit(0, ttvst::midi::ActionMap::kNumHotCues - 1, c.intValue)];
+            if (slot < 0.0) {
+                slot = playhead_.toSamples();
+                break;
+            }
+            target = slot;
+        }
+        target = std::max(0.0, target);
+        if (current != nullptr && current->getNumSamples() > 0)
+            target = std::min(target, (double)(current->getNumSamples() - 1));
+        playhead_ = ttvst::PlayheadPhase::fromSamples(target);
+        keylockActive_ = false;   // restart the stretcher at the cue
+        if (current != nullptr && current->stream != nullptr)
+            current->stream->setPlayhead(playhead_.index(), 1);   // start decoding there now, not after the block
+        break;
+    }
+    case ttvst::TransportCommand::clearHotCue:
+        hotCues_[(size_t)deck_][(size_t)juce::jlimit(0, ttvst::midi::ActionMap::kNumHotCues - 1, c.intValue)] = -1.0;
+        break;
+    case ttvst::TransportCommand::selectDeck:
+        if (c.intValue >= 0 && c.intValue < kNumDecks)
+            deck_ = c.intValue;
+        keylockActive_ = false;   // the stretcher's overlap belongs to the old track
+        break;
+    case ttvst::TransportCommand::setMotorSpeed:
+        motorSpeed_ = juce::jlimit(0.5, 2.0, c.position);
+        break;
+    case ttvst::TransportCommand::setPositionSource:
+        if (juce::jlimit(0, 1, c.intValue) != positionSource_)
+            timecode_.reset();   // reacquire from scratch, the input may have been anything meanwhile
+        positionSource_ = juce::jlimit(0, 1, c.intValue);
+        break;
+    case ttvst::TransportCommand::setKeylock:
+        keylockMode_ = juce::jlimit(0, 2, c.intValue);
+        break;
+    case ttvst::TransportCommand::setSamplerMode:
+        samplerMode_ = juce::jlimit(0, ttvst::sampler::kNumModes - 1, c.intValue);
+        if (samplerMode_ == ttvst::sampler::off)
+            voices_.releaseAll();
+        break;
+    case ttvst::TransportCommand::noteOn: {
+        // a pad plays from its hot cue up to the next one (or the track end)
+        const int slot = c.intValue - kSamplerBaseNote;
+        if (samplerMode_ == ttvst::sampler::off || current == nullptr
+            || !juce::isPositiveAndBelow(slot, ttvst::midi::ActionMap::kNumHotCues))
+            break;
+        const auto& cues = hotCues_[(size_t)deck_];
+        const double from = cues[(size_t)slot];
+        if (from < 0.0 || from >= (double)current->getNumSamples()) break;
+        double to = (double)current->getNumSamples();
+        for (const double cue : cues)
+            if (cue > from && cue < to) to = cue;
+        voices_.start(c.intValue, (float)c.position, deck_, deckGeneration_[(size_t)deck_],
+            ttvst::PlayheadPhase::fromSamples(from), ttvst::PlayheadPhase::fromSamples(to),
+            samplerMode_ == ttvst::sampler::gated);
+        break;
+    }
+    case ttvst::TransportCommand::noteOff:
+        voices_.release(c.intValue);
+        break;
+    default:
+        break;
+    }
 }
 
 int PluginTestowy2AudioProcessor::getDeltaPh(int start, int end, int hostSr) {
@@ -46,7 +297,7 @@ int PluginTestowy2AudioProcessor::renderSeg(LoadedAudioPtr srcAudio,
     const float* src = nullptr;
     int realDelta = 0;
     for (int ch = 0; ch < numCh; ch++){
-        src = srcAudio->buffer.getReadPointer(ch, playhead_);
+        src = srcAudio->getReadPointer(ch) + (int)playhead_.index();
         float* out = outBuffer.getWritePointer(ch, 0);
         realDelta = interp.process(ratio, src, out, lenOut, lenIn, 0);
         interp.reset();
@@ -55,59 +306,13 @@ int PluginTestowy2AudioProcessor::renderSeg(LoadedAudioPtr srcAudio,
 }
 
 
-static LoadedPair
-loadFileIntoAudioBuffer(juce::AudioFormatManager& fm, const juce::File& file)
-{
-    std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
-    if (!reader) return {};
-
-    const int numChannels = (int)reader->numChannels;
-    const juce::int64 numSamples64 = reader->lengthInSamples;
-    if (numChannels <= 0 || numSamples64 <= 0) return {};
-
-    // Uwaga: AudioBuffer rozmiar w int – rzutujemy swiadomie (typowo pliki < 2 31 probek)
-    const int numSamples = (int)numSamples64;
-
-    auto out = std::make_shared<LoadedAudio>();
-    out->sampleRate = (int)reader->sampleRate;
-    auto outReversed = std::make_shared<LoadedAudio>();
-    out->sampleRate = (int)reader->sampleRate;
-    outReversed->buffer.setSize(numChannels, numSamples, false, false, true);
-    out->buffer.setSize(numChannels, numSamples, false, false, true);
-    // setSize(ch, samples, keepContent=false, clearExtraSpace=false, avoidReallocating=true)
-
-    // Czytamy partiami, by wspierac bardzo dlugie pliki
-    const int block = 16384;
-    juce::int64 filePos = 0;
-
-    while (filePos < numSamples64)
-    {
-        const int toRead = (int)std::min<juce::int64>(block, numSamples64 - filePos);
-
-        // Czytamy bezposrednio do bufora docelowego (destStart = (int)filePos)
-        // Flagi true/true odnosza sis do L/R przy plikach stereo — przy mono/wiecej kanalow
-        // JUCE i tak wypelni dostepne kanaly; to najczestszy przypadek (1–2 ch).
-        if (!reader->read(&out->buffer,
-            (int)filePos,            // destStartSample
-            toRead,                   // numSamples
-            filePos,                  // start w pliku
-            true, true))              // (left/right for stereo)
-            break;
-
-        filePos += toRead;
-    }
-    outReversed->buffer.makeCopyOf(out->buffer);
-    outReversed->buffer.reverse(0, numSamples);
-
-    return { out, outReversed };
+LoadedAudioPtr PluginTestowy2AudioProcessor::getLoaded(int deck) const{
+    auto track = deckTracks_[(size_t)deck]->getShared();
+    return track ? track->forward : nullptr;
 }
-LoadedAudioPtr PluginTestowy2AudioProcessor::getLoaded() const noexcept{
-    // atomowy odczyt wskaznika (acquire para dla release w loaderze)
-    return std::atomic_load_explicit(&loaded_, std::memory_order_acquire);
-}
-LoadedAudioPtr PluginTestowy2AudioProcessor::getLoadedReversed() const noexcept {
-    // atomowy odczyt wskaznika (acquire para dla release w loaderze)
-    return std::atomic_load_explicit(&loadedReversed_, std::memory_order_acquire);
+LoadedAudioPtr PluginTestowy2AudioProcessor::getLoadedReversed(int deck) const {
+    auto track = deckTracks_[(size_t)deck]->getShared();
+    return track ? track->reversed : nullptr;
 }
 
 PluginTestowy2AudioProcessor::PluginTestowy2AudioProcessor()
@@ -116,16 +321,51 @@ PluginTestowy2AudioProcessor::PluginTestowy2AudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #else
+                       .withInput  ("Timecode", juce::AudioChannelSet::stereo(), false) // control signal from a turntable
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Stem 2", juce::AudioChannelSet::stereo(), false)   // stems of a multichannel track
+                       .withOutput ("Stem 3", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Stem 4", juce::AudioChannelSet::stereo(), false)
                      #endif
                        )
 #endif
 {
+    for (auto& handle : deckTracks_)
+        handle = std::make_unique<ttvst::TrackHandle>(trackCache_->getReclaimer());
+    for (auto& g : stemGain_)
+        g.store(1.0f);
+
+    tapKnots_ = signalTap_.addStream("knots", 2);          // time, position
+    tapPosition_ = signalTap_.addStream("position", 1);    // scratch curve, while it drives
+    tapRatio_ = signalTap_.addStream("ratio", 1);          // scratch/timecode ratio, while it drives
+    tapOutput_ = signalTap_.addStream("output", 2);        // first two output channels
+    tapGovernor_ = signalTap_.addStream("governor", 2);    // level, load; once per block
+
+    for (auto& cues : hotCues_)
+        cues.fill(-1.0);
+    juce::StringArray mapErrors;
+    midiActions_.load(getMidiMapFile(), &mapErrors);
+    for (const auto& e : mapErrors)
+        DBG("midi map: " << e);
+    umpPosition_.setController(midiActions_.getPositionController());
+}
+
+juce::File PluginTestowy2AudioProcessor::getMidiMapFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("ttvst").getChildFile("midimap.txt");
 }
 
 PluginTestowy2AudioProcessor::~PluginTestowy2AudioProcessor()
 {
+    // pending loads call back into this instance
+    trackCache_->cancelRequestsFor(this);
+
+    // release the decks while the cache (and its reclaimer) is still alive
+    for (int d = 0; d < kNumDecks; ++d)
+        publishTrack(d, {}, nullptr, nullptr, {});
 }
 
 //==============================================================================
@@ -197,10 +437,48 @@ void PluginTestowy2AudioProcessor::prepareToPlay (double sampleRate, int samples
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     hostSampleRate_ = sampleRate;
-    playhead_ = 0.0; // reset on (re)start
-    motorState = false;
+    playhead_ = {}; // reset on (re)start
+    // rendering happens per source channel (see stemRender), whatever the output layout
+    decodeScratch_.setSize(kMaxRenderChannels, samplesPerBlock * kMaxScratchRatio + 2 + ttvst::interp::kMaxBefore + ttvst::interp::kMaxAfter,
+        false, false, true);
+    stemRenderFloat_.setSize(kMaxRenderChannels, samplesPerBlock, false, true, true);
+    stemRenderDouble_.setSize(kMaxRenderChannels, samplesPerBlock, false, true, true);
+    voiceRenderFloat_.setSize(kMaxRenderChannels, samplesPerBlock, false, true, true);
+    voiceRenderDouble_.setSize(kMaxRenderChannels, samplesPerBlock, false, true, true);
+    voiceGain_.assign((size_t)samplesPerBlock, 0.0f);
+    gatherIndex_.assign((size_t)samplesPerBlock, 0);
+    gatherFrac_.assign((size_t)samplesPerBlock, 0.0);
+    for (int k = 0; k < kMaxStems; ++k)
+        stemGainInUse_[(size_t)k] = stemGain_[(size_t)k].load();
+    keylock_.prepare(kMaxRenderChannels, samplesPerBlock);
+    keylockXfade_.setSize(kMaxRenderChannels, kKeylockXfade, false, false, true);
+    keylockOut_.setSize(kMaxRenderChannels, samplesPerBlock, false, false, true);
+    phaseSteps_.reserve((size_t)samplesPerBlock);
+    ratios_.reserve((size_t)samplesPerBlock);
+    timecode_.prepare(sampleRate, samplesPerBlock);
+    timecodeCycles_.assign((size_t)samplesPerBlock, 0.0);
+    timecodeIn_.setSize(2, samplesPerBlock, false, false, true);
+    timecodeStatus_ = {};
+    scratchSpline_.prepare(kMaxSplineKnots);
+    scopeRecorder_.reset();
+    tapScratch_.assign((size_t)samplesPerBlock * 2, 0.0);
+    blockTime_ = 0;
+    preparedBlockSize_ = samplesPerBlock;
+    scratchLatency_ = scratchWindow_.load() * samplesPerBlock;
+    keylockActive_ = false;
+    brakeLength_ = juce::jmax(1, (int)(kBrakeSeconds * sampleRate));
+    brakeLeft_ = 0;
+    loopSeam_.setSize(kMaxRenderChannels, ttvst::interp::kMaxBefore + kLoopXfade + ttvst::interp::kMaxAfter + 1, false, true, true);
+    ttvst::interp::Sinc::table();   // built here, not on the audio thread
+    governor_.prepare(sampleRate, samplesPerBlock);
+    governorLevel_ = ttvst::LoadGovernor::full;
+    telemetryBlocks_ = 0;
+    for (int k = 0; k < kLoopXfade; ++k)
+        loopFade_[(size_t)k] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * (float)k / (float)kLoopXfade);
+    // motorState/loop_/deck_ are left alone: they belong to the transport queue,
+    // and hosts call prepareToPlay again on every sample-rate/block-size change
     //playheadReversed_ = 0;
-    setLatencySamples(samplesPerBlock);
+    setLatencySamples(scratchLatency_);
 
 }
 
@@ -225,10 +503,20 @@ bool PluginTestowy2AudioProcessor::isBusesLayoutSupported (const BusesLayout& la
      && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
 
+    // stem outputs are stereo or switched off
+    for (int b = 1; b < layouts.outputBuses.size(); ++b)
+        if (! layouts.outputBuses[b].isDisabled() && layouts.outputBuses[b] != juce::AudioChannelSet::stereo())
+            return false;
+
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+   #else
+    // the optional timecode input is a stereo pair or nothing
+    if (! layouts.getMainInputChannelSet().isDisabled()
+     && layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
    #endif
 
     return true;
@@ -236,224 +524,955 @@ bool PluginTestowy2AudioProcessor::isBusesLayoutSupported (const BusesLayout& la
 }
 #endif
 
-void PluginTestowy2AudioProcessor::beginLoadFile(const juce::File& file)
-{
-    DBG("beginLoadFile: " << file.getFullPathName());
-
-    std::thread([this, file]
-        {
-            juce::AudioFormatManager fm;
-            fm.registerBasicFormats(); // WAV/AIFF/FLAC/MP3* (MP3 depends on defines)
-
-            auto[ data, dataReversed ] = loadFileIntoAudioBuffer(fm, file); // std::shared_ptr<LoadedAudio>
-            if (data && dataReversed)
-            {   
-                DBG("Loaded: " << file.getFileName()
-                    << "  SR=" << data->sampleRate
-                    << "  ch=" << data->buffer.getNumChannels()
-                    << "  samples=" << data->buffer.getNumSamples());
-
-                // Publish as const to match the field type `std::shared_ptr<const LoadedAudio>`
-                // NOTE: atomic_store/atomic_load overloads for shared_ptr are declared in <memory>.
-                if (data->getNumSamples() == dataReversed->getNumSamples()) {
-                    std::shared_ptr<const LoadedAudio> published = std::move(data);
-                    std::atomic_store_explicit(&loaded_, published, std::memory_order_release);
-                    std::shared_ptr<const LoadedAudio> publishedReversed = std::move(dataReversed);
-                    std::atomic_store_explicit(&loadedReversed_, publishedReversed, std::memory_order_release);
-                }
-                else {
-                    DBG("data and its reversed version have unexpected differences");
-                }
-                DBG("LOADEDD");
+void PluginTestowy2AudioProcessor::beginLoadFile(const juce::File& file, int deck)
+{
+    DBG("beginLoadFile: " << file.getFullPathName() << " deck=" << deck);
+    startLoad(file, deck, {}, std::nullopt);
+}
+
+juce::File PluginTestowy2AudioProcessor::getLoadedFile(int deck) const
+{
+    if (deck < 0 || deck >= kNumDecks) return {};
+    const juce::ScopedLock sl(deckInfoLock_);
+    return deckInfo_[(size_t)deck].file;
+}
+
+void PluginTestowy2AudioProcessor::publishTrack(int deck, const juce::String& cacheKey,
+    LoadedAudioPtr data, LoadedAudioPtr dataReversed, const juce::String& contentHash)
+{
+    {
+        // the track on air stays pinned in the cache until the deck moves on
+        const juce::ScopedLock sl(deckInfoLock_);
+        auto& info = deckInfo_[(size_t)deck];
+        if (info.cacheKey.isNotEmpty()) trackCache_->unpin(info.cacheKey);
+        info.cacheKey = cacheKey;
+        if (cacheKey.isNotEmpty()) trackCache_->pin(cacheKey);
+        if (contentHash.isNotEmpty()) info.contentHash = contentHash;
+    }
+
+    // A streamed track decodes only while some deck plays it; the lock pairs each
+    // addDeck with the removeDeck of whatever replaces it
+    const juce::ScopedLock sl(deckInfoLock_);
+    const auto previous = deckTracks_[(size_t)deck]->getShared();
+    if (data && data->stream) data->stream->addDeck();
+
+    // The cache handed the pages over faulted in (see TrackCache), so the audio thread
+    // does not fault the first time the needle lands on them.
+    // Publishing is a pointer swap, whether the audio came from the cache or a fresh decode.
+    // The previous track is released later, off the audio thread (see TrackHandle).
+    deckTracks_[(size_t)deck]->publish(std::move(data), std::move(dataReversed));
+    if (previous && previous->forward->stream) previous->forward->stream->removeDeck();
+}
+
+void PluginTestowy2AudioProcessor::startLoad(const juce::File& file, int deck,
+    const juce::String& expectedHash, std::optional<double> restorePlayhead)
+{
+    if (deck < 0 || deck >= kNumDecks) return;
+
+    // a newer request for the same deck wins, whatever order the jobs finish in
+    const int generation = ++loadGeneration_[(size_t)deck];
+    const auto storage = (ttvst::codec::SampleStorage)sampleStorage_.load();
+    const auto key = ttvst::TrackCache::makeKey(file, storage);
+
+    {
+        const juce::ScopedLock sl(deckInfoLock_);
+        deckInfo_[(size_t)deck].file = file;
+        deckInfo_[(size_t)deck].contentHash = expectedHash;
+    }
+
+    // Cached, in use by another instance, or already decoding for someone else:
+    // the cache hands back the shared buffers and only decodes once
+    auto onReady = [this, key, deck, generation, expectedHash, restorePlayhead](const ttvst::TrackCache::Entry* e)
+    {
+        if (e == nullptr) {
+            DBG("Failed to load: " << key);
+            return;
+        }
+        if (generation != loadGeneration_[(size_t)deck].load()) {
+            DBG("startLoad: stale load dropped: " << key);
+            return;
+        }
+        if (expectedHash.isNotEmpty() && e->contentHash != expectedHash)
+            DBG("startLoad: " << key << " changed since the session was saved");
+
+        DBG("Loaded: " << key
+            << "  SR=" << e->forward->sampleRate
+            << "  ch=" << e->forward->getNumChannels()
+            << "  samples=" << e->forward->getNumSamples()
+            << "  MB=" << (double)e->forward->getMemoryBytes() / (1024.0 * 1024.0));
+
+        if (e->forward->getNumSamples() != e->reversed->getNumSamples()) {
+            DBG("data and its reversed version have unexpected differences");
+            return;
+        }
+
+        publishTrack(deck, key, e->forward, e->reversed, e->contentHash);
+        if (restorePlayhead) jumpToCue(*restorePlayhead, deck);
+        DBG("LOADEDD");
+    };
+
+    // a restored session decodes from where it left off, the rest follows behind
+    trackCache_->request(this, file, storage, std::move(onReady), restorePlayhead ? (int)*restorePlayhead : 0);
+}
+
+void PluginTestowy2AudioProcessor::preloadFile(const juce::File& file)
+{
+    trackCache_->preload(file, getSampleStorage());
+}
+
+void PluginTestowy2AudioProcessor::setLockSampleMemory(bool shouldLock)
+{
+    trackCache_->setLockPinned(shouldLock);
+}
+
+bool PluginTestowy2AudioProcessor::getLockSampleMemory() const
+{
+    return trackCache_->getLockPinned();
+}
+
+ttvst::mem::Residency PluginTestowy2AudioProcessor::getDeckResidency(int deck) const
+{
+    ttvst::mem::Residency total;
+    if (deck < 0 || deck >= kNumDecks) return total;
+
+    total.measured = true;
+    for (const auto& audio : { getLoaded(deck), getLoadedReversed(deck) }) {
+        if (audio == nullptr) continue;
+        const auto r = ttvst::mem::measure(*audio);
+        total.bytes += r.bytes;
+        total.residentBytes += r.residentBytes;
+        total.measured = total.measured && r.measured;
+    }
+
+    const juce::ScopedLock sl(deckInfoLock_);
+    const auto& key = deckInfo_[(size_t)deck].cacheKey;
+    total.locked = key.isNotEmpty() && trackCache_->isLocked(key);
+    return total;
+}
+
+ttvst::TrackCache& PluginTestowy2AudioProcessor::getTrackCache() noexcept
+{
+    return *trackCache_;
+}
+
+void PluginTestowy2AudioProcessor::setSampleStorage(ttvst::codec::SampleStorage storage)
+{
+    sampleStorage_.store((int)storage);
+}
+
+ttvst::codec::SampleStorage PluginTestowy2AudioProcessor::getSampleStorage() const noexcept
+{
+    return (ttvst::codec::SampleStorage)sampleStorage_.load();
+}
+
+void PluginTestowy2AudioProcessor::publishTransportSnapshot() noexcept
+{
+    playheadSnapshot_.store(playhead_.toSamples(), std::memory_order_relaxed);
+    motorSnapshot_.store(motorState, std::memory_order_relaxed);
+    loopSnapshot_.store(loop_, std::memory_order_relaxed);
+    loopStartSnapshot_.store(loopStart_, std::memory_order_relaxed);
+    loopLengthSnapshot_.store(loopLength_, std::memory_order_relaxed);
+    deckSnapshot_.store(deck_, std::memory_order_relaxed);
+    motorSpeedSnapshot_.store(motorSpeed_, std::memory_order_relaxed);
+    keylockSnapshot_.store(keylockMode_, std::memory_order_relaxed);
+    samplerSnapshot_.store(samplerMode_, std::memory_order_relaxed);
+    positionSourceSnapshot_.store(positionSource_, std::memory_order_relaxed);
+    timecodeSignalSnapshot_.store(timecodeStatus_.signal, std::memory_order_relaxed);
+    timecodeLockedSnapshot_.store(timecodeStatus_.locked, std::memory_order_relaxed);
+    timecodeSpeedSnapshot_.store(timecodeStatus_.speed, std::memory_order_relaxed);
+}
+
+PluginTestowy2AudioProcessor::LoopRegion PluginTestowy2AudioProcessor::getLoopRegion(int numSamples) const noexcept
+{
+    LoopRegion r;
+    if (!loop_ || numSamples <= 0) return r;
+
+    // no explicit region: the whole track loops
+    r.start = loopLength_ > 0 ? juce::jlimit(0, numSamples - 1, loopStart_) : 0;
+    r.end = loopLength_ > 0 ? juce::jmin(r.start + loopLength_, numSamples) : numSamples;
+    if (r.end - r.start < kMinLoop) return r;
+
+    r.xfade = juce::jmin(kLoopXfade, (r.end - r.start) / 2);
+    r.on = true;
+    return r;
+}
+
+// Builds the loop seam: the last `xfade` samples before the loop end, crossfaded into
+// the audio leading up to the loop start, plus the loop start itself as successor.
+// Played through the seam, the loop is one continuous periodic signal in both directions.
+void PluginTestowy2AudioProcessor::buildLoopSeam(const LoadedAudio& data, const int* srcChannel, int numCh,
+    const LoopRegion& r) noexcept
+{
+    // only what the loader has written: the rest of a progressive load is silence
+    const auto decoded = data.getDecodedRange();
+    auto sampleOrZero = [&](int ch, int i) noexcept {
+        return decoded.contains(i) ? data.getSample(ch, i) : 0.0f;
+    };
+
+    for (int ch = 0; ch < numCh; ++ch) {
+        float* seam = loopSeam_.getWritePointer(ch) + ttvst::interp::kMaxBefore;
+        const int sc = srcChannel[ch];
+        // the interpolator's taps before the seam read the track as it plays up to it
+        for (int k = 1; k <= ttvst::interp::kMaxBefore; ++k)
+            seam[-k] = sampleOrZero(sc, r.end - r.xfade - k);
+        for (int k = 0; k < r.xfade; ++k) {
+            const float g = loopFade_[(size_t)(k * kLoopXfade / r.xfade)];
+            seam[k] = sampleOrZero(sc, r.end - r.xfade + k) * (1.0f - g) + sampleOrZero(sc, r.start - r.xfade + k) * g;
+        }
+        // and the ones past it the loop start, plus one for rounding at the region edge
+        for (int k = 0; k <= ttvst::interp::kMaxAfter; ++k)
+            seam[r.xfade + k] = sampleOrZero(sc, r.start + k);
+    }
+}
+
+// Touches the cache lines the playhead reaches next, so a fast scratch into audio it has
+// not played yet does not stall on memory. Hints only: nothing past the guards is named.
+// frameStride is 1 for planar channels, the frame width for an interleaved track.
+static void prefetchAhead(const float* const* chans, int numCh, int frameStride, int64_t at, int64_t direction,
+    int srcN) noexcept
+{
+    constexpr int kLine = 64 / (int)sizeof(float);
+    constexpr int kLines = 4;
+    const int64_t stride = (direction < 0 ? -kLine : kLine) / frameStride;
+    for (int k = 1; k <= kLines; ++k) {
+        const int64_t idx = at + k * stride;
+        if (idx < -LoadedAudio::kGuard || idx >= srcN + LoadedAudio::kGuard) break;
+        for (int ch = 0; ch < numCh; ++ch)
+            ttvst::mem::prefetch(chans[ch] + idx * frameStride);
+    }
+}
+
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::renderVarispeed(const LoadedAudio& data, FloatType* const* out, int numCh,
+    int start, int end, ttvst::PlayheadPhase& ph, bool scratching, bool followLoop) noexcept
+{
+    // ph advances by the spline ratios while scratching, by the pitch fader under the motor.
+    // The block is cut into runs over which ph stays inside one region (track, loop seam,
+    // beyond the ends); wraps and clamps happen between runs, so the interpolation
+    // kernel itself never tests a boundary. Guard samples cover index -1 and numSamples.
+    using Phase = ttvst::PlayheadPhase;
+    const int srcN = data.getNumSamples();
+    const int srcCh = data.getNumChannels();
+    const bool windowed = ttvst::codec::isWindowed(data.storage);   // 16-bit or streamed: spans decoded per run
+    const bool framed = data.storage == ttvst::codec::SampleStorage::float32Frames;
+    if (windowed) numCh = juce::jmin(numCh, decodeScratch_.getNumChannels());
+
+    std::array<int, kMaxRenderChannels> srcChannel{};
+    for (int ch = 0; ch < numCh; ++ch)
+        srcChannel[(size_t)ch] = juce::jmin(ch, srcCh - 1); // mono sources feed every output
+
+    const auto loop = followLoop ? getLoopRegion(srcN) : LoopRegion{};
+    if (loop.on)
+        buildLoopSeam(data, srcChannel.data(), numCh, loop);
+
+    // a track still decoding plays only what the loader has written, once per block
+    const auto decoded = data.getDecodedRange();
+    const bool partial = decoded.to - decoded.from + decoded.wrapTo < srcN;
+
+    std::array<const float*, kMaxRenderChannels> track{}, seam{}, window{};
+    for (int ch = 0; ch < numCh; ++ch) {
+        if (!windowed && !framed) track[(size_t)ch] = data.getReadPointer(srcChannel[(size_t)ch]);
+        seam[(size_t)ch] = loopSeam_.getReadPointer(ch) + ttvst::interp::kMaxBefore;
+        window[(size_t)ch] = decodeScratch_.getReadPointer(ch);
+    }
+
+    // fixed-point increments, exact to accumulate (see PlayheadPhase)
+    const int64_t motorStep = Phase::step(motorRatio());
+    const int64_t* steps = scratching ? phaseSteps_.data() : nullptr;
+
+    // The playhead walks the run once into index/fraction arrays; the gather loops
+    // (RenderKernels.h) then read them, per frame on interleaved tracks. The loops are
+    // instantiated per interpolator and channel count (1, 2, any) and picked here, once:
+    // nothing inside a run dispatches on either.
+    const auto& kernels = ttvst::render::selectKernels<FloatType>(interpInUse_, numCh);
+    int64_t* const gatherIndex = gatherIndex_.data();
+    double* const gatherFrac = gatherFrac_.data();
+    auto walk = [&](int64_t base, int from, int to) noexcept
+    {
+        for (int i = from; i < to; i++) {
+            gatherIndex[i] = ph.index() - base;
+            gatherFrac[i] = ph.frac<double>();
+            ph += scratching ? steps[i] : motorStep;
+        }
+    };
+    auto run = [&](const float* const* chans, int64_t base, int from, int to) noexcept
+    {
+        walk(base, from, to);
+        kernels.gather(chans, numCh, gatherIndex, gatherFrac, out, from, to);
+    };
+    // Motor playback needs neither: a constant ratio steps the phase inside the gather,
+    // and exactly unity on a whole sample is the track itself
+    const int64_t unityStep = Phase::step(1.0);
+    auto runConstant = [&](const float* const* chans, int from, int to) noexcept
+    {
+        kernels.constant(chans, numCh, ph.raw, motorStep, out, from, to);
+        ph.raw += (int64_t)(to - from) * motorStep;
+    };
+    auto copyRun = [&](int from, int to) noexcept
+    {
+        const int first = (int)ph.index(), n = to - from;
+        for (int ch = 0; ch < numCh; ++ch) {
+            if constexpr (std::is_same_v<FloatType, float>) {
+                data.readSpan(srcChannel[(size_t)ch], first, n, out[ch] + from);
+            }
+            else {
+                float* widened = decodeScratch_.getWritePointer(ch);
+                data.readSpan(srcChannel[(size_t)ch], first, n, widened);
+                for (int k = 0; k < n; ++k)
+                    out[ch][from + k] = (FloatType)widened[k];
             }
+        }
+        ph.raw += (int64_t)n * motorStep;
+    };
+    auto runFrames = [&](int from, int to) noexcept
+    {
+        walk(0, from, to);
+        const auto gatherFrames = data.getFrameStride() == 4 ? kernels.frames4 : kernels.frames2;
+        gatherFrames(data.getFramePointer(), srcChannel.data(), numCh, gatherIndex, gatherFrac, out, from, to);
+    };
+
+    // decoded windows carry the widest reader's taps on both sides
+    constexpr int kTapsBefore = ttvst::interp::kMaxBefore, kTapsAfter = ttvst::interp::kMaxAfter;
+    const int64_t windowCap = windowed ? (int64_t)decodeScratch_.getNumSamples() - kTapsBefore - kTapsAfter
+                                      : std::numeric_limits<int64_t>::max();
+    const auto loopStart = Phase::fromIndex(loop.start), loopEnd = Phase::fromIndex(loop.end);
+    const auto seamStart = Phase::fromIndex(loop.end - loop.xfade);
+    const int64_t loopLen = loopEnd.raw - loopStart.raw;
+    auto wrapIntoLoop = [&]() noexcept {
+        auto d = (ph.raw - loopStart.raw) % loopLen;
+        ph.raw = loopStart.raw + (d < 0 ? d + loopLen : d);
+    };
+
+    int i = start;
+    while (i < end) {
+        // region holding ph; `wraps` = leaving it through either side wraps around the loop
+        enum { inTrack, inSeam, outside } kind = inTrack;
+        Phase lo = Phase::fromIndex(-1), hi = Phase::fromIndex(srcN);
+        bool wraps = false;
+
+        if (loop.on && ph >= loopEnd)
+            wrapIntoLoop();   // landed past the loop end
+
+        if (ph < Phase::fromIndex(-1))     { kind = outside; lo = Phase::lowest(); hi = Phase::fromIndex(-1); }
+        else if (!loop.on || ph < loopStart) { if (loop.on) hi = loopStart; }
+        else if (ph < seamStart)           { lo = loopStart; hi = seamStart; wraps = true; }
+        else                               { kind = inSeam; lo = seamStart; hi = loopEnd; wraps = true; }
+        if (kind == inTrack && !loop.on && ph >= Phase::fromIndex(srcN)) { kind = outside; lo = Phase::fromIndex(srcN); hi = Phase::highest(); }
+        if (kind == inTrack && partial) {
+            // [from, to) and [-1, wrapTo): runs stop at their edges, the gaps play as silence
+            const auto from = Phase::fromIndex(decoded.from == 0 ? -1 : decoded.from), to = Phase::fromIndex(decoded.to);
+            const auto wrapTo = Phase::fromIndex(decoded.wrapTo);
+            if (ph >= from && ph < to)                          { lo = std::max(lo, from); hi = std::min(hi, to); }
+            else if (decoded.wrapTo > 0 && ph < wrapTo)         { hi = std::min(hi, wrapTo); }
+            else {
+                kind = outside;
+                if (ph >= to) lo = std::max(lo, to);
+                if (decoded.wrapTo > 0 && ph >= wrapTo) lo = std::max(lo, wrapTo);
+                if (ph < from) hi = std::min(hi, from);
+            }
+        }
+
+        // run length, plus the source span it touches (windowed tracks decode only that)
+        int runEnd = i;
+        int64_t spanLo = ph.index(), spanHi = spanLo;
+        if (!scratching) {
+            // constant step: where the run leaves the region is arithmetic
+            int64_t len = end - i;
+            if (motorStep > 0) len = std::min<int64_t>(len, (hi.raw - ph.raw - 1) / motorStep + 1);
+            if (motorStep < 0) len = std::min<int64_t>(len, (ph.raw - lo.raw) / -motorStep + 1);
+            if (windowed && motorStep != 0)   // the span plus rounding fits the window
+                len = std::min<int64_t>(len, Phase::fromIndex(windowCap - 3).raw / std::abs(motorStep) + 1);
+            const Phase last{ ph.raw + (len - 1) * motorStep };
+            spanLo = std::min(ph.index(), last.index());
+            spanHi = std::max(ph.index(), last.index());
+            runEnd = i + (int)len;
+        }
+        else {
+            for (Phase p = ph; runEnd < end && p >= lo && p < hi; ++runEnd) {
+                const auto idx = p.index();
+                const auto nLo = std::min(spanLo, idx), nHi = std::max(spanHi, idx);
+                if (nHi - nLo + 2 > windowCap) break;
+                spanLo = nLo; spanHi = nHi;
+                p += steps[runEnd];
+            }
+        }
+
+        if (kind == outside) {
+            for (int ch = 0; ch < numCh; ++ch)
+                std::fill(out[ch] + i, out[ch] + runEnd, (FloatType)0);
+            if (!scratching)
+                ph.raw += (int64_t)(runEnd - i) * motorStep;
             else
-            {
-                DBG("Failed to load: " << file.getFullPathName());
+                for (int k = i; k < runEnd; ++k)
+                    ph += steps[k];
+        }
+        else if (kind == inSeam) {
+            run(seam.data(), loop.end - loop.xfade, i, runEnd);
+        }
+        else if (!scratching && motorStep == unityStep && (uint32_t)ph.raw == 0) {
+            copyRun(i, runEnd);
+        }
+        else if (framed) {
+            runFrames(i, runEnd);
+            if (scratching) {
+                const float* frames = data.getFramePointer();
+                prefetchAhead(&frames, 1, data.getFrameStride(), gatherIndex[runEnd - 1], ph.index() - gatherIndex[runEnd - 1], srcN);
             }
-        }).detach();
+        }
+        else if (!windowed && !scratching) {
+            runConstant(track.data(), i, runEnd);
+        }
+        else if (!windowed) {
+            run(track.data(), 0, i, runEnd);
+            prefetchAhead(track.data(), numCh, 1, gatherIndex[runEnd - 1], ph.index() - gatherIndex[runEnd - 1], srcN);
+        }
+        else {
+            // widen [spanLo - taps, spanHi + taps] once with the vectorized decoder; the guards cover both ends
+            const int64_t from = spanLo - kTapsBefore;
+            for (int ch = 0; ch < numCh; ++ch)
+                data.readSpan(srcChannel[(size_t)ch], (int)from, (int)(spanHi - from + 1 + kTapsAfter), decodeScratch_.getWritePointer(ch));
+            run(window.data(), from, i, runEnd);
+        }
+
+        if (wraps && (ph >= loopEnd || ph < loopStart))
+            wrapIntoLoop();
+        i = runEnd;
+    }
+
+    // without a loop the needle rests just past either end of the track
+    if (!loop.on) {
+        if (ph < Phase::fromIndex(-1)) ph = Phase::fromIndex(-1);
+        if (ph >= Phase::fromIndex(srcN)) ph = Phase::fromIndex(srcN);
+    }
 }
 
-void PluginTestowy2AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+template <typename FloatType>
+juce::AudioBuffer<FloatType>& PluginTestowy2AudioProcessor::stemRender() noexcept
 {
-    using namespace ttvst::helps;
-    using namespace ttvst::splines;
-    juce::ScopedNoDenormals _;
-    juce::MidiBuffer midiThisBlock = midiMessages;
-    const int totalNumInputChannels = getTotalNumInputChannels();
-    const int totalNumOutputChannels = getTotalNumOutputChannels();
+    if constexpr (std::is_same_v<FloatType, float>) return stemRenderFloat_;
+    else return stemRenderDouble_;
+}
 
-    // Capture MIDI for the UI
-    for (const auto metadata : midiMessages)
-        midiLog_.pushFromAudioThread(metadata.getMessage(), metadata.samplePosition);
+template <typename FloatType>
+juce::AudioBuffer<FloatType>& PluginTestowy2AudioProcessor::voiceRender() noexcept
+{
+    if constexpr (std::is_same_v<FloatType, float>) return voiceRenderFloat_;
+    else return voiceRenderDouble_;
+}
 
-    buffer.clear();
-    offsets_ = {};
-    values_ = {};
-    ratios_ = {};
-
-    //Snapshot loaded data
-    auto data = getLoaded();
-    auto dataReversed = getLoadedReversed();
-    if (!data || !dataReversed) return;
-    const int srcCh = data->buffer.getNumChannels();
-    const int srcN = data->buffer.getNumSamples();
-    const int outCh = buffer.getNumChannels();
-    const int outN = buffer.getNumSamples();
-    if (srcN <= 0) return;
+// Brake steps for [start, end): the motor ratio falling linearly to zero over the brake
+// time. Returns how many samples of the range the platter still turns.
+int PluginTestowy2AudioProcessor::fillBrakeSteps(int start, int end) noexcept
+{
+    const double from = motorRatio();
+    const int n = juce::jmin(end - start, brakeLeft_);
+    if (phaseSteps_.size() < (size_t)end) phaseSteps_.resize((size_t)end);
+    for (int i = 0; i < n; ++i)
+        phaseSteps_[(size_t)(start + i)] = ttvst::PlayheadPhase::step(from * (double)(brakeLeft_ - i) / (double)brakeLength_);
+    return n;
+}
+
+// How the platter moves over [start, end), taken before renderRange advances the brake
+// (which leaves the same steps in phaseSteps_)
+PluginTestowy2AudioProcessor::PlatterRun PluginTestowy2AudioProcessor::platterRun(int start, int end,
+    int blockLength) noexcept
+{
+    if (ratios_.size() == (size_t)blockLength) return { end - start, true, std::numeric_limits<int>::max() };
+    if (brakeLeft_ > 0) return { fillBrakeSteps(start, end), true, brakeLeft_ };
+    return { motorState ? end - start : 0, false, motorState ? std::numeric_limits<int>::max() : 0 };
+}
+
+// Sampler voices ride the same platter as the deck: each one renders through
+// renderVarispeed at the deck's steps (scratch, brake or motor), ignoring the loop, into
+// voiceRender, and is added to the stems under its envelope. A voice releases as it
+// nears the end of its region or the platter nears its stop, and ends when its deck loads
+// another track.
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::renderVoices(juce::AudioBuffer<FloatType>& stems,
+    const std::array<const LoadedAudio*, kNumDecks>& decks, int start, int end, PlatterRun platter) noexcept
+{
+    using Phase = ttvst::PlayheadPhase;
+    const int turning = platter.turning;
+    const bool perSample = platter.perSample;
+    const int64_t motorStep = Phase::step(motorRatio());
+    auto& scratch = voiceRender<FloatType>();
+
+    for (auto& v : voices_.voices()) {
+        if (!v.active) continue;
+        const auto* data = decks[(size_t)v.deck];
+        if (data == nullptr || deckGeneration_[(size_t)v.deck] != v.generation) {
+            v.active = false;
+            continue;
+        }
+
+        // platter still: nothing to play, the voice is released and lets go silently
+        if (turning == 0) {
+            v.held = false;
+            v.target = 0.0f;
+            ttvst::sampler::VoicePool::envelope(v, voiceGain_.data(), end - start);
+            continue;
+        }
+
+        // The release starts kFade samples before the read position would leave the
+        // region in the direction it moves, or before the brake stops the platter, and
+        // plays on past the edge: the audio beyond the region is the track itself
+        const int n = turning;
+        int release = n;
+        Phase p = v.ph;
+        for (int i = 0; i < n; ++i) {
+            const int64_t s = perSample ? phaseSteps_[(size_t)(start + i)] : motorStep;
+            const int64_t room = s > 0 ? v.hi.raw - p.raw : v.lo.raw - p.raw;
+            if (platter.stopsIn - i <= ttvst::sampler::VoicePool::kFade
+                || (s != 0 && room / s <= ttvst::sampler::VoicePool::kFade)) {
+                release = i;
+                break;
+            }
+            p.raw += s;
+        }
+
+        const int numCh = juce::jmin(stems.getNumChannels(), kMaxRenderChannels, juce::jmax(2, data->getNumChannels()));
+        std::array<FloatType*, kMaxRenderChannels> out{};
+        for (int ch = 0; ch < numCh; ++ch)
+            out[(size_t)ch] = scratch.getWritePointer(ch);
+        renderVarispeed(*data, out.data(), numCh, start, start + n, v.ph, perSample, false);
+
+        int played = ttvst::sampler::VoicePool::envelope(v, voiceGain_.data(), release);
+        if (played == release && release < n) {
+            v.held = false;
+            v.target = 0.0f;
+            played += ttvst::sampler::VoicePool::envelope(v, voiceGain_.data() + release, n - release);
+        }
+        if (v.active && n < end - start) {
+            // the platter stopped under a voice its release has not finished: fade the rest
+            const int fade = juce::jmin(played, ttvst::sampler::VoicePool::kFade);
+            for (int k = 0; k < fade; ++k)
+                voiceGain_[(size_t)(played - fade + k)] *= (float)(fade - k) / (float)(fade + 1);
+            v.active = false;
+        }
 
-    if (hasPitchWheelMessage(lastMidi_)) {
-        DBG("proessBlock: lastMIDI has msgs");
+        for (int ch = 0; ch < numCh; ++ch) {
+            FloatType* dst = stems.getWritePointer(ch) + start;
+            const FloatType* src = out[(size_t)ch] + start;
+            for (int k = 0; k < played; ++k)
+                dst[k] += src[k] * (FloatType)voiceGain_[(size_t)k];
+        }
     }
-    else {
-        DBG("processBlock: lastMIDI no msgs");
+}
+
+// Stem k (channels 2k, 2k+1 of stems; a lone last channel is a mono stem) goes to output
+// bus k if the host enabled it, to the main bus otherwise. Fader moves ramp over the block.
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::mixStems(juce::AudioBuffer<FloatType>& buffer,
+    const juce::AudioBuffer<FloatType>& stems) noexcept
+{
+    const int outN = stems.getNumSamples();
+    const int numStems = juce::jmin(kMaxStems, (stems.getNumChannels() + 1) / 2);
+    const int numBuses = getBusCount(false);
+
+    for (int k = 0; k < numStems; ++k) {
+        const float g0 = stemGainInUse_[(size_t)k];
+        const float g1 = stemGain_[(size_t)k].load(std::memory_order_relaxed);
+        stemGainInUse_[(size_t)k] = g1;
+        if (g0 == 0.0f && g1 == 0.0f) continue;
+
+        const int bus = k < numBuses && getChannelCountOfBus(false, k) > 0 ? k : 0;
+        auto out = getBusBuffer(buffer, false, bus);
+        const int width = juce::jmin(2, stems.getNumChannels() - 2 * k);
+        for (int ch = 0; ch < out.getNumChannels(); ++ch)
+            out.addFromWithRamp(ch, 0, stems.getReadPointer(2 * k + juce::jmin(ch, width - 1)), outN,
+                (FloatType)g0, (FloatType)g1);
     }
+}
 
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::renderRange(juce::AudioBuffer<FloatType>& buffer,
+    const LoadedAudio& data, int start, int end) noexcept
+{
+    const int outN = buffer.getNumSamples();
+    // the track's own channels (a mono track still fills a pair); the rest of buffer stays silent
+    const int numCh = juce::jmin(buffer.getNumChannels(), kMaxRenderChannels, juce::jmax(2, data.getNumChannels()));
+    const bool scratching = ratios_.size() == outN;
+
+    std::array<FloatType*, kMaxRenderChannels> out{};
+    for (int ch = 0; ch < numCh; ++ch)
+        out[(size_t)ch] = buffer.getWritePointer(ch);
+
+    // The stretcher works in float; on a double bus it renders through keylockOut_
+    constexpr bool isFloat = std::is_same_v<FloatType, float>;
+    std::array<float*, kMaxRenderChannels> stretchOut{};
+    for (int ch = 0; ch < numCh; ++ch) {
+        if constexpr (isFloat) stretchOut[(size_t)ch] = out[(size_t)ch];
+        else stretchOut[(size_t)ch] = keylockOut_.getWritePointer(ch);   // same indices as out
+    }
+    auto mixOutKeylock = [&]() noexcept {
+        const int n = juce::jmin(kKeylockXfade, end - start);
+        if constexpr (!isFloat)
+            for (int ch = 0; ch < numCh; ++ch)
+                for (int i = start; i < start + n; ++i) stretchOut[(size_t)ch][i] = (float)out[(size_t)ch][i];
+        keylock_.mixOutTail(data, stretchOut.data(), numCh, start, n);
+        if constexpr (!isFloat)
+            for (int ch = 0; ch < numCh; ++ch)
+                for (int i = start; i < start + n; ++i) out[(size_t)ch][i] = (FloatType)stretchOut[(size_t)ch][i];
+        keylockActive_ = false;
+    };
+
+    if (!scratching && !motorState) {
+        // motor off and no platter movement: the block stays cleared, playhead holds
+        if (keylockActive_)
+            mixOutKeylock();
+        return;
+    }
 
-    //IF HOST RESIZES BUFFER THEN DROP LAST BLOCK AND UPDATE LAST BLOCK SIZE
-    if (lastBlock_.getNumChannels() != outCh || lastBlock_.getNumSamples() != outN) {
-        lastBlock_.setSize(outCh, outN, false, true, true);
-        DBG("block resized");
-        haveLastMidi_ = false;
+    if (!scratching && brakeLeft_ > 0) {
+        // brake: the motor ratio falls linearly to zero, rendered per sample like a scratch;
+        // once stopped the rest of the range stays cleared
+        const int n = fillBrakeSteps(start, end);
+        renderVarispeed(data, out.data(), numCh, start, start + n, playhead_, true);
+        brakeLeft_ -= n;
+        if (brakeLeft_ == 0)
+            motorState = false;
+        if (keylockActive_)
+            mixOutKeylock();
+        return;
     }
 
-    //get last midi
-    auto optOff = getPitchWheelOffsetsVector(lastMidi_);
-    auto optVal = getPitchWheelValueVector(lastMidi_);
-    if (optOff && optVal) {
-        //push last midi
-        
-        offsets_ = std::move(*optOff);
+    // Keylock only under the motor, forwards, and only when the fader is off unity
+    const auto mode = (ttvst::KeylockEngine::Mode)keylockMode_;
+    const bool keylockNow = !scratching && !reverse_ && mode != ttvst::KeylockEngine::off && motorSpeed_ != 1.0;
+
+    // The stretcher reads straight through; around a loop end hand over to the varispeed
+    // path, which plays the seam, and re-engage after the wrap
+    const auto loop = getLoopRegion(data.getNumSamples());
+    const double position = playhead_.toSamples();
+    const bool nearLoopEnd = loop.on && position >= (double)loop.start
+        && position + (double)(end - start + 1) * motorSpeed_ >= (double)(loop.end - loop.xfade);
+
+    if (keylockNow && !nearLoopEnd) {
+        const bool engaging = !keylockActive_ || keylock_.getMode() != mode;
+        int xfade = 0;
+        if (engaging) {
+            // raw varispeed for the first few samples, to crossfade from
+            xfade = juce::jmin(kKeylockXfade, end - start);
+            std::array<float*, kMaxRenderChannels> raw{};
+            for (int ch = 0; ch < numCh; ++ch)
+                raw[(size_t)ch] = keylockXfade_.getWritePointer(ch);
+            auto ph = playhead_;
+            renderVarispeed(data, raw.data(), numCh, 0, xfade, ph, false);
+            keylock_.reset(data, playhead_, motorSpeed_, mode);
+        }
 
-        std::vector<double >values = pitchWheelToSamplePositionVec(*optVal);
-        values_ = std::move(values);
-        DBG("processBlock: lastMIDI msgs PUSHED");
-    }
-    else {
-        DBG("ProcessBlock: no msgs in LAST MIDI");
+        keylock_.process(data, stretchOut.data(), numCh, start, end - start, motorSpeed_);
+        playhead_ = keylock_.getPosition();
+        keylockActive_ = true;
+
+        for (int ch = 0; ch < numCh; ++ch) {
+            float* s = stretchOut[(size_t)ch];
+            for (int i = 0; i < xfade; ++i) {
+                const float g = (float)(i + 1) / (float)(xfade + 1);
+                s[start + i] = s[start + i] * g + keylockXfade_.getSample(ch, i) * (1.0f - g);
+            }
+            if constexpr (!isFloat)
+                for (int i = start; i < end; ++i) out[(size_t)ch][i] = (FloatType)s[i];
+        }
+        return;
     }
 
-    if (preRenderOffset && preRenderValue) {
-        offsets_.insert(offsets_.begin(), *preRenderOffset);
-        values_.insert(values_.begin(), *preRenderValue);
-        DBG("processBlock: PRE render msg PUSHED");
+    renderVarispeed(data, out.data(), numCh, start, end, playhead_, scratching);
+
+    // scratch, unity speed or a loop wrap took over from keylock: fade its pending output out
+    if (keylockActive_)
+        mixOutKeylock();
+}
+
+template <typename FloatType>
+ttvst::timecode::Decoder::Status PluginTestowy2AudioProcessor::decodeTimecodeInput(
+    const juce::AudioBuffer<FloatType>& buffer) noexcept
+{
+    if (positionSource_ != timecodeSource || getTotalNumInputChannels() < 2)
+        return {};
+
+    const int n = juce::jmin(buffer.getNumSamples(), (int)timecodeCycles_.size());
+    const float* left = nullptr;
+    const float* right = nullptr;
+    if constexpr (std::is_same_v<FloatType, float>) {
+        left = buffer.getReadPointer(0);
+        right = buffer.getReadPointer(1);
     }
     else {
-        DBG("processBlock: no PRE render values to push");
+        for (int ch = 0; ch < 2; ++ch) {
+            float* dst = timecodeIn_.getWritePointer(ch);
+            const FloatType* src = buffer.getReadPointer(ch);
+            for (int i = 0; i < n; ++i) dst[i] = (float)src[i];
+        }
+        left = timecodeIn_.getReadPointer(0);
+        right = timecodeIn_.getReadPointer(1);
     }
 
-    if (auto meta = getFirstPitchWheelMessage(midiMessages)) {
-        offsets_.push_back(meta->samplePosition + outN);
-        double value = meta->getMessage().getPitchWheelValue();
-        value = pitchWheelToSamplePosition(value);
-        values_.push_back(value);
-        DBG("processBlock: AFTER render msg PUSHED");
+    auto st = timecode_.process(left, right, n, timecodeCycles_.data());
+    if (n < buffer.getNumSamples()) st.signal = false;   // block larger than prepared for
+    return st;
+}
+
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::writeSignalTaps(const juce::AudioBuffer<FloatType>& buffer,
+    int64_t renderStart, double curveStart) noexcept
+{
+    if (!signalTap_.isRecording()) return;
+    const int n = juce::jmin(buffer.getNumSamples(), (int)tapScratch_.size() / 2);
+
+    if (ratios_.size() == (size_t)buffer.getNumSamples()) {
+        signalTap_.write(tapRatio_, renderStart, ratios_.data(), n);
+        if (signalTap_.isOn(tapPosition_) && !timecodeStatus_.signal) {
+            double p = curveStart;
+            for (int i = 0; i < n; ++i)
+                tapScratch_[(size_t)i] = (p += ratios_[(size_t)i]);
+            signalTap_.write(tapPosition_, renderStart, tapScratch_.data(), n);
+        }
     }
-    else {
-        DBG("processBlock: no AFTER render values to push");
+
+    if (signalTap_.isOn(tapOutput_) && buffer.getNumChannels() > 0) {
+        const FloatType* l = buffer.getReadPointer(0);
+        const FloatType* r = buffer.getReadPointer(juce::jmin(1, buffer.getNumChannels() - 1));
+        for (int i = 0; i < n; ++i) {
+            tapScratch_[(size_t)(2 * i)] = (double)l[i];
+            tapScratch_[(size_t)(2 * i + 1)] = (double)r[i];
+        }
+        signalTap_.write(tapOutput_, renderStart, tapScratch_.data(), n);
     }
+}
 
-    
+void PluginTestowy2AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const juce::AudioProcessLoadMeasurer::ScopedTimer timer(governor_.getMeasurer(), buffer.getNumSamples());
+    processBlockImpl(buffer, midiMessages);
+}
 
+void PluginTestowy2AudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const juce::AudioProcessLoadMeasurer::ScopedTimer timer(governor_.getMeasurer(), buffer.getNumSamples());
+    processBlockImpl(buffer, midiMessages);
+}
 
+bool PluginTestowy2AudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename FloatType>
+void PluginTestowy2AudioProcessor::processBlockImpl(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    using namespace ttvst::helps;
+    using namespace ttvst::splines;
+    juce::ScopedNoDenormals _;
+    const int totalNumInputChannels = getTotalNumInputChannels();
+    const int totalNumOutputChannels = getTotalNumOutputChannels();
 
-    
-    if (offsets_.size() > 1) {
+    // Capture MIDI for the UI
+    for (const auto metadata : midiMessages)
+        midiLog_.pushFromAudioThread(metadata.getMessage(), metadata.samplePosition);
 
-        
-        for (double val : values_) {
-            DBG(val);
-        }
-        vector<splineSet> splineSet = spline(offsets_, values_);
-        DBG("spline set ok");
-        vector<double> Y = createPositionVector(splineSet, offsets_, values_, outN);  
-        DBG("pos vector ok " << Y.size());
-        vector<double> ratios = createRatiosVector(Y, preRenderValue);
-        DBG("ratios size: " << ratios.size());
-        ratios_ = ratios;
-        DBG("processBlock: vector creation executed");
-        //save_vector_csv("dblVec.csv", Y, 12);
-        if (!Y.empty()) {
-            //sets proper prerender if the generated vector is not empty
-            preRenderValue = Y.back();
-            DBG("prerendervalue: " << *preRenderValue);
-            preRenderOffset = -1;
-            //Y = pitchWheelToSamplePositionVec(Y);
-            DBG("processBlock: pre render values assigned from vector");
-            //append_vector_csv("R2.csv", ratios, 12);
-            //append_vector_csv("P2.csv", Y, 12);
-            DBG("processBlock: appended vector of length: " << Y.size());
-        }
-        else {
-            DBG("processBlock: position vector is empty?");
-            preRenderValue.reset();
-            preRenderValue.reset();
+    // The timecode input arrives in the same buffer the output goes to: decode it first
+    timecodeStatus_ = decodeTimecodeInput(buffer);
+
+    buffer.clear();
+    ratios_.clear();
+
+    const int outN = buffer.getNumSamples();
+
+    // Out of headroom last blocks: render this one cheaper (see LoadGovernor::Level)
+    using Governor = ttvst::LoadGovernor;
+    governorLevel_ = governor_.update(blockTime_, outN);
+    int interpCap = ttvst::interp::sinc;
+    if (governorLevel_ >= Governor::linearInterp) interpCap = ttvst::interp::linear;
+    else if (governorLevel_ >= Governor::hermiteInterp) interpCap = ttvst::interp::hermite;
+    interpInUse_ = juce::jmin(interpolation_.load(std::memory_order_relaxed), interpCap);
+    scratchSpline_.setLinear(governorLevel_ >= Governor::linearKnots);
+    const bool telemetryThisBlock = governorLevel_ < Governor::sparseTelemetry
+        || telemetryBlocks_++ % Governor::kSparseEvery == 0;
+    {
+        const double g[2] = { (double)governorLevel_, governor_.getLoad() };
+        signalTap_.write(tapGovernor_, blockTime_, g, 1);
+    }
+
+    // Pitch-wheel knots join the spline at their absolute time; the render runs
+    // scratchLatency_ behind, so each segment it enters already has knots after it.
+    // A MIDI 2.0 controller's 32-bit packets (tunnelled in SysEx) are knots on the same scale.
+    const int latency = scratchWindow_.load(std::memory_order_relaxed) * preparedBlockSize_;
+    if (latency != scratchLatency_) {
+        scratchSpline_.reset();
+        scratchLatency_ = latency;
+    }
+    for (const auto metadata : midiMessages) {
+        const auto msg = metadata.getMessage();
+        uint32_t wide = 0;
+        const bool isKnot = msg.isPitchWheel()
+            || (msg.isSysEx() && umpPosition_.decodeSysEx(msg.getSysExData(), msg.getSysExDataSize(), wide));
+        if (isKnot) {
+            const int64_t t = blockTime_ + metadata.samplePosition;
+            const double value = msg.isPitchWheel() ? pitchWheelToSamplePosition(msg.getPitchWheelValue())
+                                                    : pitchBend32ToSamplePosition(wide);
+            if (!scratchSpline_.addKnot(t, value))
+                knotOverflows_.fetch_add(1, std::memory_order_relaxed);
+            scopeRecorder_.addKnot(t, value);
+            const double knot[2] = { (double)t, value };
+            signalTap_.write(tapKnots_, t, knot, 1);
         }
     }
+    const int64_t renderStart = blockTime_ - scratchLatency_;
+    const double curveStart = scratchSpline_.getPosition();
+    ratios_.resize((size_t)outN);
+    if (scratchSpline_.render(renderStart, outN, ratios_.data())) {
+        phaseSteps_.resize(ratios_.size());
+        for (size_t i = 0; i < ratios_.size(); ++i)
+            phaseSteps_[i] = ttvst::PlayheadPhase::step(ratios_[i]);
+    }
     else {
-        DBG("processBlock: no messages to create vector from");
-        preRenderValue.reset();
-        preRenderValue.reset();
-        DBG("processBlock: pre render values reset");
-    }
-
-
-    if (ratios_.size() == outN) {
-        for (int i = 0; i < outN; i++) {
-            auto index0 = (unsigned long)playhead_;
-            auto index1 = index0 == (srcN - 1) ? (unsigned int)0 : index0 + 1;
-            auto frac = playhead_ - (double)index0;
-            for (int ch = 0; ch < outCh; ch++) {
-                auto value0 = *data->buffer.getReadPointer(ch, index0);
-                auto value1 = *data->buffer.getReadPointer(ch, index1);
-                auto currentSample = value0 + frac * (value1 - value0);
-                buffer.setSample(ch, i, (float)currentSample);
-            }
-            playhead_ += ratios_[i];
+        ratios_.clear();
+    }
+    blockTime_ += outN;
+
+    // Transport commands from the UI, ordered by offset, applied while rendering below
+    int numCommands = transport_.drainTo(blockCommands_, outN);
+
+    // Mapped controller pads and knobs join them at their own sample; in sampler mode
+    // the notes left unmapped start and stop voices the same way
+    for (const auto metadata : midiMessages) {
+        const auto msg = metadata.getMessage();
+        const int offset = juce::jlimit(0, juce::jmax(0, outN - 1), metadata.samplePosition);
+        ttvst::TransportCommand c;
+        if (midiActions_.toCommand(msg, offset, c)) {
+            numCommands = ttvst::insertByOffset(blockCommands_, numCommands, c);
+        }
+        else if (samplerMode_ != ttvst::sampler::off && (msg.isNoteOn() || msg.isNoteOff())) {
+            c.type = msg.isNoteOn() ? ttvst::TransportCommand::noteOn : ttvst::TransportCommand::noteOff;
+            c.sampleOffset = offset;
+            c.intValue = msg.getNoteNumber();
+            c.position = msg.getFloatVelocity();
+            numCommands = ttvst::insertByOffset(blockCommands_, numCommands, c);
         }
     }
-    else {
-        for (int i = 0; i < outN; i++) {
-            auto index0 = (unsigned long)playhead_;
-            for (int ch = 0; ch < outCh; ch++) {
-                float value = *data->buffer.getReadPointer(0, index0);
-                buffer.setSample(ch, i, value);
-            }
-            playhead_ += 1;
+
+    //Snapshot loaded data (every deck, a selectDeck command can switch mid-block).
+    //Raw pointers stay valid until the reads are closed when this block returns.
+    struct DeckReads {
+        std::array<std::unique_ptr<ttvst::TrackHandle>, kNumDecks>& handles;
+        ~DeckReads() { for (auto& h : handles) h->endRead(); }
+    } deckReads{ deckTracks_ };
+
+    std::array<const LoadedAudio*, kNumDecks> decks{};
+    bool anyLoaded = false;
+    for (int d = 0; d < kNumDecks; ++d) {
+        const auto* track = deckTracks_[(size_t)d]->beginRead();
+        if (track != nullptr && track->generation != deckGeneration_[(size_t)d]) {
+            // a new track on this deck: the cues were positions in the old one
+            deckGeneration_[(size_t)d] = track->generation;
+            hotCues_[(size_t)d].fill(-1.0);
         }
+        if (track != nullptr && track->forward->getNumSamples() > 0) {
+            decks[(size_t)d] = track->forward.get();
+            anyLoaded = true;
+        }
+    }
+    if (!anyLoaded) {
+        for (int c = 0; c < numCommands; ++c)
+            applyTransportCommand(blockCommands_[(size_t)c], nullptr);
+        voices_.clear();
+        setRecorder_.push(getBusBuffer(buffer, false, 0));   // the silence too: the set keeps its timing
+        publishTransportSnapshot();
+        return;
     }
-    
-    
 
+    // A turntable playing the control record replaces the pitch-wheel curve: same ratios,
+    // same renderer, but sample-by-sample from the audio input instead of 14-bit MIDI
+    if (timecodeStatus_.signal) {
+        if (const auto* data = decks[(size_t)deck_]) {
+            const double samplesPerCycle = data->sampleRate / timecode_.getFormat().carrierHz;
+            ratios_.resize((size_t)outN);
+            phaseSteps_.resize((size_t)outN);
+            for (int i = 0; i < outN; ++i) {
+                ratios_[(size_t)i] = timecodeCycles_[(size_t)i] * samplesPerCycle;
+                phaseSteps_[(size_t)i] = ttvst::PlayheadPhase::step(ratios_[(size_t)i]);
+            }
 
+            // absolute position known and far from ours: the needle was dropped somewhere else
+            if (timecodeStatus_.locked) {
+                const double target = timecodeStatus_.position * samplesPerCycle;
+                if (std::abs(target - playhead_.toSamples()) > kTimecodeResync)
+                    playhead_ = ttvst::PlayheadPhase::fromSamples(target);
+            }
+        }
+    }
 
+    // Stopped (motor off, platter still, nothing queued, no keylock tail or voice to fade): the
+    // block is silence and the buffer stays as cleared above, which is the flag
+    // (hasBeenCleared) the host wrappers read; no stem pass, no mix
+    const bool stopped = numCommands == 0 && !motorState && ratios_.size() != (size_t)outN && !keylockActive_
+        && !voices_.anyActive();
+
+    // One playhead pass renders every source channel into the stem buffer; the stems
+    // are mixed onto their output buses after the whole block is rendered
+    if (!stopped) {
+        auto& stemStore = stemRender<FloatType>();
+        int stemChannels = 2;
+        for (const auto* d : decks)
+            if (d != nullptr) stemChannels = juce::jmax(stemChannels, d->getNumChannels());
+        stemChannels = juce::jmin(stemChannels, stemStore.getNumChannels());
+        juce::AudioBuffer<FloatType> stems(stemStore.getArrayOfWritePointers(), stemChannels, outN);
+        stems.clear();
+
+        // Render in segments split at command offsets, so commands land sample-accurately
+        int nextCommand = 0;
+        int segStart = 0;
+        while (segStart < outN) {
+            while (nextCommand < numCommands && blockCommands_[(size_t)nextCommand].sampleOffset <= segStart)
+                applyTransportCommand(blockCommands_[(size_t)nextCommand++], decks[(size_t)deck_]);
+
+            const int segEnd = nextCommand < numCommands ? blockCommands_[(size_t)nextCommand].sampleOffset : outN;
+            const auto platter = platterRun(segStart, segEnd, outN);
+            if (const auto* data = decks[(size_t)deck_])
+                renderRange(stems, *data, segStart, segEnd);
+            renderVoices(stems, decks, segStart, segEnd, platter);
+            segStart = segEnd;
+        }
+        mixStems(buffer, stems);
+    }
 
+    // A streamed track decodes around where the deck is now, ahead in the way it is going
+    if (const auto* data = decks[(size_t)deck_]; data != nullptr && data->stream != nullptr) {
+        const double ratio = ratios_.size() == (size_t)outN ? ratios_.back() : motorRatio();
+        data->stream->setPlayhead(playhead_.index(), ratio < 0.0 ? -1 : 1);
+    }
 
-    if (!preRenderValue.has_value() || !preRenderOffset.has_value()) {
-        if (auto meta = getLastPitchWheelMessage(lastMidi_)) {
-            preRenderOffset = meta->samplePosition - outN; 
-            double value = meta->getMessage().getPitchWheelValue();
-            preRenderValue = pitchWheelToSamplePosition(value);
-            
-            DBG("first iteration pre render msg saved");
-        }
-        else {
-            DBG("no pitch wheel message in last midi");
+    // and around every pad: where its voice plays now, or its hot cue
+    for (int d = 0; d < kNumDecks; ++d) {
+        const auto* data = decks[(size_t)d];
+        if (data == nullptr || data->stream == nullptr) continue;
+        static_assert(ttvst::ChunkStream::kNumAnchors >= ttvst::midi::ActionMap::kNumHotCues, "one anchor per cue");
+        for (int slot = 0; slot < ttvst::midi::ActionMap::kNumHotCues; ++slot) {
+            double at = samplerMode_ != ttvst::sampler::off ? hotCues_[(size_t)d][(size_t)slot] : -1.0;
+            for (const auto& v : voices_.voices())
+                if (v.active && v.deck == d && v.note == kSamplerBaseNote + slot)
+                    at = v.ph.toSamples();
+            data->stream->setAnchor(slot, at < 0.0 ? -1 : (int64_t)at);
         }
     }
-    
 
-    offsets_.clear();
-    values_.clear();
-    afterRenderOffset.reset();
-    afterRenderValue.reset();
-    
-    if (hasPitchWheelMessage(midiMessages)) {
-        lastMidi_.swapWith(midiMessages);
+    // Scope: what the platter followed this block, on the spline's time axis
+    if (ratios_.size() == (size_t)outN) {
+        if (!timecodeStatus_.signal)
+            scopeRecorder_.setPosition(curveStart);
+        scopeRecorder_.push(ratios_.data(), 0.0, renderStart, outN);
     }
     else {
-        lastMidi_.clear();
+        scopeRecorder_.push(nullptr, motorState ? motorRatio() : 0.0, renderStart, outN);
+    }
+    if (telemetryThisBlock) {
+        scopeRecorder_.publishTo(scope_);
+        writeSignalTaps(buffer, renderStart, curveStart);
     }
 
+    setRecorder_.push(getBusBuffer(buffer, false, 0));
+    publishTransportSnapshot();
 }
 
 //==============================================================================
@@ -470,15 +1489,86 @@ juce::AudioProcessorEditor* PluginTestowy2AudioProcessor::createEditor()
 //==============================================================================
 void PluginTestowy2AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // Track references only (path + content hash), never audio: restoring must stay cheap
+    juce::XmlElement xml("TTVST_STATE");
+    xml.setAttribute("version", 1);
+    xml.setAttribute("playhead", playheadSnapshot_.load());
+    xml.setAttribute("motor", motorSnapshot_.load());
+    xml.setAttribute("loop", loopSnapshot_.load());
+    xml.setAttribute("loopStart", loopStartSnapshot_.load());
+    xml.setAttribute("loopLength", loopLengthSnapshot_.load());
+    xml.setAttribute("deck", deckSnapshot_.load());
+    xml.setAttribute("storage", sampleStorage_.load());
+    xml.setAttribute("motorSpeed", motorSpeedSnapshot_.load());
+    xml.setAttribute("keylock", keylockSnapshot_.load());
+    xml.setAttribute("sampler", samplerSnapshot_.load());
+    xml.setAttribute("positionSource", positionSourceSnapshot_.load());
+    xml.setAttribute("scratchWindow", scratchWindow_.load());
+    xml.setAttribute("interpolation", interpolation_.load());
+    xml.setAttribute("governor", governor_.isEnabled());
+    xml.setAttribute("loadLimit", governor_.getLoadLimit());
+    for (int k = 0; k < kMaxStems; ++k)
+        xml.setAttribute("stemGain" + juce::String(k), (double)stemGain_[(size_t)k].load());
+
+    {
+        const juce::ScopedLock sl(deckInfoLock_);
+        for (int d = 0; d < kNumDecks; ++d) {
+            const auto& info = deckInfo_[(size_t)d];
+            if (info.file == juce::File()) continue;
+            auto* deck = xml.createNewChildElement("DECK");
+            deck->setAttribute("index", d);
+            deck->setAttribute("filePath", info.file.getFullPathName());
+            deck->setAttribute("contentHash", info.contentHash);
+        }
+    }
+
+    copyXmlToBinary(xml, destData);
 }
 
 void PluginTestowy2AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // Returns straight away: transport goes through the command queue and decks reload
+    // on the shared loader pool. Restored decks are silent until their track is published.
+    auto xml = getXmlFromBinary(data, sizeInBytes);
+    if (xml == nullptr || !xml->hasTagName("TTVST_STATE")) return;
+
+    const double playhead = xml->getDoubleAttribute("playhead", 0.0);
+    const int currentDeck = juce::jlimit(0, kNumDecks - 1, xml->getIntAttribute("deck", 0));
+    setSampleStorage((ttvst::codec::SampleStorage)juce::jlimit(0, (int)ttvst::codec::SampleStorage::streamed,
+        xml->getIntAttribute("storage", 0)));
+
+    selectDeck(currentDeck);
+    setLoopState(xml->getBoolAttribute("loop", true));
+    setLoopRegion(xml->getIntAttribute("loopStart", 0), xml->getIntAttribute("loopLength", 0));
+    setMotorState(xml->getBoolAttribute("motor", false));
+    setMotorSpeed(xml->getDoubleAttribute("motorSpeed", 1.0));
+    setKeylockMode(xml->getIntAttribute("keylock", 0));
+    setSamplerMode(xml->getIntAttribute("sampler", ttvst::sampler::off));
+    setPositionSource(xml->getIntAttribute("positionSource", pitchWheelSource));
+    setScratchWindow(xml->getIntAttribute("scratchWindow", 1));
+    setInterpolation(xml->getIntAttribute("interpolation", ttvst::interp::sinc));
+    governor_.setEnabled(xml->getBoolAttribute("governor", true));
+    governor_.setLoadLimit(xml->getDoubleAttribute("loadLimit", 0.5));
+    for (int k = 0; k < kMaxStems; ++k)
+        setStemGain(k, (float)xml->getDoubleAttribute("stemGain" + juce::String(k), 1.0));
+    jumpToCue(playhead, currentDeck); // again once a reloaded track is published
+
+    for (auto* deck : xml->getChildWithTagNameIterator("DECK")) {
+        const int index = deck->getIntAttribute("index", -1);
+        if (index < 0 || index >= kNumDecks) continue;
+
+        const juce::File file(deck->getStringAttribute("filePath"));
+        const auto hash = deck->getStringAttribute("contentHash");
+        if (!file.existsAsFile()) {
+            DBG("setStateInformation: missing track " << file.getFullPathName());
+            continue;
+        }
+        if (file == getLoadedFile(index) && getLoaded(index) != nullptr)
+            continue; // same track still in memory
+
+        publishTrack(index, {}, nullptr, nullptr, {});
+        startLoad(file, index, hash, index == currentDeck ? std::optional<double>(playhead) : std::nullopt);
+    }
 }
 
 //==============================================================================
@@ -12,8 +12,28 @@
 #include <memory>
 #include <atomic>
 #include <vector>
+#include <array>
+#include <optional>
 #include "LoadedAudio.h"
 #include "MidiMessageManager.h"
+#include "TransportCommandQueue.h"
+#include "TrackLoader.h"
+#include "TrackCache.h"
+#include "TrackHandle.h"
+#include "KeylockEngine.h"
+#include "PlayheadPhase.h"
+#include "Timecode.h"
+#include "SlidingSpline.h"
+#include "ScopeBuffer.h"
+#include "SignalTap.h"
+#include "SetRecorder.h"
+#include "SamplerVoices.h"
+#include "MemoryResidency.h"
+#include "Interpolators.h"
+#include "RenderKernels.h"
+#include "LoadGovernor.h"
+#include "MidiActionMap.h"
+#include "UmpPosition.h"
 #include "helpers.h"
 
 //==============================================================================
@@ -30,13 +50,96 @@ public:
     ~PluginTestowy2AudioProcessor() override;
 
 
+    static constexpr int kNumDecks = 2;
+    static constexpr int kMaxRenderChannels = 16;
+    static constexpr int kMaxStems = kMaxRenderChannels / 2;   // stereo pairs of a multichannel track
+    static constexpr int kNumOutputBuses = 4;                   // main + "Stem 2".."Stem 4"
+    static constexpr int kMaxScratchRatio = 16;   // widest |ratio| the windowed-storage scratch covers
+    static constexpr int kKeylockXfade = 256;     // samples, keylock <-> raw varispeed handoff
+    static constexpr int kLoopXfade = 64;         // samples, loop seam crossfade
+    static constexpr int kMinLoop = 4;            // shorter loop regions are ignored
+    static constexpr double kTimecodeResync = 2048.0;   // samples of timecode/playhead disagreement that mean a needle drop
+    static constexpr int kMaxScratchWindow = 4;   // blocks of pitch-wheel lookahead
+    static constexpr int kMaxSplineKnots = 4096;
+    static constexpr double kBrakeSeconds = 0.6;   // motor spin-down of the brake action
+    static constexpr int kSamplerBaseNote = 36;    // C1 plays hot cue 0, up to G1 for cue 7
+
+    // What moves the platter
+    enum PositionSource { pitchWheelSource = 0, timecodeSource };
+
     ttvst::MidiMessageManager& getMidiLog() noexcept { return midiLog_; }
 
-    std::shared_ptr<const LoadedAudio> getLoaded() const noexcept;
-    std::shared_ptr<const LoadedAudio> getLoadedReversed() const noexcept;
-    void beginLoadFile(const juce::File& file);
+    // Strong references for non-audio threads; processBlock reads deckTracks_ directly
+    std::shared_ptr<const LoadedAudio> getLoaded(int deck = 0) const;
+    std::shared_ptr<const LoadedAudio> getLoadedReversed(int deck = 0) const;
+    void beginLoadFile(const juce::File& file, int deck = 0);
+    juce::File getLoadedFile(int deck) const;
+
+    // Decode into the process-wide track cache without touching any deck,
+    // so switching to it later is only a pointer publish
+    void preloadFile(const juce::File& file);
+    ttvst::TrackCache& getTrackCache() noexcept;
+
+    // Keep the pages of on-air tracks locked in RAM (process-wide, through the track cache)
+    void setLockSampleMemory(bool shouldLock);
+    bool getLockSampleMemory() const;
+    // How much of the deck's track (both directions) is in RAM. Message thread, a syscall per call.
+    ttvst::mem::Residency getDeckResidency(int deck) const;
+
+    // RAM format for tracks loaded from now on (float32 / int16 / half / interleaved float32),
+    // or streamed: left on disk and decoded in chunks around the playhead
+    void setSampleStorage(ttvst::codec::SampleStorage storage);
+    ttvst::codec::SampleStorage getSampleStorage() const noexcept;
     int getDeltaPh(int endVal, int startVal, int hostSr);
+
+    // Transport control, safe to call from any non-audio thread.
+    // Applied by processBlock at the start of the next block.
     void setMotorState(bool state);
+    void setLoopState(bool state);
+    void setLoopRegion(double startSample, int lengthSamples);   // length 0 = whole track
+    void jumpToCue(double sourcePosition, int deck = -1);   // deck: only if it is still the selected one
+    void setMotorSpeed(double speed);     // pitch fader, 1.0 = nominal
+    double getMotorSpeed() const noexcept;
+    void setKeylockMode(int mode);        // ttvst::KeylockEngine::Mode
+    int getKeylockMode() const noexcept;
+    void setSamplerMode(int mode);        // ttvst::sampler::Mode: notes play the hot cues
+    int getSamplerMode() const noexcept;
+    void selectDeck(int deck);
+    double getPlayheadPosition() const noexcept;   // source samples, as of the last block
+    void setPositionSource(int source);            // PositionSource
+    int getPositionSource() const noexcept;
+    ttvst::timecode::Decoder::Status getTimecodeStatus() const noexcept;   // as of the last block
+    // Stem faders, any thread. Stem k is source channels 2k, 2k+1; it plays on output bus k
+    // when that bus is enabled, otherwise in the main mix.
+    void setStemGain(int stem, float gain);
+    float getStemGain(int stem) const noexcept;
+    // Pitch-wheel lookahead in blocks (1..kMaxScratchWindow); reported as latency.
+    // More blocks give the spline more knots ahead of the render, at that much delay.
+    void setScratchWindow(int blocks);
+    int getScratchWindow() const noexcept;
+    // Pitch-wheel knots that found the spline window full; each restarted the curve
+    uint32_t getKnotOverflows() const noexcept { return knotOverflows_.load(std::memory_order_relaxed); }
+    // Decimated scratch curve, published by the audio thread; one reader (the editor)
+    ttvst::TripleBuffer<ttvst::ScopeFrame>& getScope() noexcept { return scope_; }
+    // Record the knots/position/ratio/output streams to a .ttap file (Scripts/read_tap.py).
+    // Message thread.
+    bool startSignalTap(const juce::File& file);
+    void stopSignalTap();
+    bool isSignalTapRecording() const noexcept;
+    // Record the main output as the audience hears it, a new part every hour (SetRecorder).
+    // Message thread.
+    bool startSetRecording(const juce::File& folder, ttvst::SetRecorder::Format format);
+    void stopSetRecording();
+    const ttvst::SetRecorder& getSetRecorder() const noexcept { return setRecorder_; }
+    // Best interpolator the renderer may use (ttvst::interp::Kind); the governor may cap it lower
+    void setInterpolation(int kind);
+    int getInterpolation() const noexcept;
+    // Steps quality down under CPU pressure; level, load and transitions for the editor
+    ttvst::LoadGovernor& getGovernor() noexcept { return governor_; }
+    // Controller note/CC bindings (see ttvst::midi::ActionMap), read from this file
+    // when the processor is created
+    static juce::File getMidiMapFile();
+    int getNumMidiBindings() const noexcept { return midiActions_.getNumBindings(); }
 
     int renderSeg(LoadedAudioPtr srcAudio,
         juce::AudioSampleBuffer outBuffer,
@@ -54,6 +157,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
     
 
     //==============================================================================
@@ -84,27 +189,148 @@ public:
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginTestowy2AudioProcessor)
-    std::shared_ptr<const LoadedAudio> loaded_, loadedReversed_;
+    void pushTransportCommand(const ttvst::TransportCommand& c);
+    void applyTransportCommand(const ttvst::TransportCommand& c, const LoadedAudio* current) noexcept;
+    double motorRatio() const noexcept { return reverse_ ? -motorSpeed_ : motorSpeed_; }
+    template <typename FloatType>
+    ttvst::timecode::Decoder::Status decodeTimecodeInput(const juce::AudioBuffer<FloatType>& buffer) noexcept;
+    template <typename FloatType>
+    void processBlockImpl(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages);
+    template <typename FloatType>
+    void writeSignalTaps(const juce::AudioBuffer<FloatType>& buffer, int64_t renderStart, double curveStart) noexcept;
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType>& stemRender() noexcept;
+    template <typename FloatType>
+    void mixStems(juce::AudioBuffer<FloatType>& buffer, const juce::AudioBuffer<FloatType>& stems) noexcept;
+    template <typename FloatType>
+    void renderRange(juce::AudioBuffer<FloatType>& buffer, const LoadedAudio& data, int start, int end) noexcept;
+    struct LoopRegion
+    {
+        int start = 0, end = 0;     // [start, end) in source samples
+        int xfade = 0;              // seam length before end
+        bool on = false;
+    };
+    LoopRegion getLoopRegion(int numSamples) const noexcept;
+    void buildLoopSeam(const LoadedAudio& data, const int* srcChannel, int numCh, const LoopRegion& r) noexcept;
+    template <typename FloatType>
+    void renderVarispeed(const LoadedAudio& data, FloatType* const* out, int numCh, int start, int end,
+        ttvst::PlayheadPhase& ph, bool scratching, bool followLoop = true) noexcept;
+    int fillBrakeSteps(int start, int end) noexcept;
+    struct PlatterRun
+    {
+        int turning = 0;            // samples of the range the platter moves
+        bool perSample = false;     // steps in phaseSteps_ (scratch, brake), else the motor step
+        int stopsIn = 0;            // samples until the brake stops it, int max while it keeps turning
+    };
+    PlatterRun platterRun(int start, int end, int blockLength) noexcept;
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType>& voiceRender() noexcept;
+    template <typename FloatType>
+    void renderVoices(juce::AudioBuffer<FloatType>& stems, const std::array<const LoadedAudio*, kNumDecks>& decks,
+        int start, int end, PlatterRun platter) noexcept;
+    void startLoad(const juce::File& file, int deck, const juce::String& expectedHash, std::optional<double> restorePlayhead);
+    void publishTrack(int deck, const juce::String& cacheKey, LoadedAudioPtr data, LoadedAudioPtr dataReversed,
+        const juce::String& contentHash);
+    void publishTransportSnapshot() noexcept;
+
+    // What is (or is being) loaded on each deck, for get/setStateInformation.
+    // Message/loader threads only.
+    struct DeckInfo
+    {
+        juce::File   file;
+        juce::String contentHash;
+        juce::String cacheKey;      // pinned in trackCache_ while published
+    };
+    std::array<DeckInfo, kNumDecks> deckInfo_;
+    juce::CriticalSection deckInfoLock_;
+    std::array<std::atomic<int>, kNumDecks> loadGeneration_{};
+    juce::SharedResourcePointer<ttvst::TrackCache> trackCache_;
+    std::array<std::unique_ptr<ttvst::TrackHandle>, kNumDecks> deckTracks_;   // after trackCache_: dies first
+    std::atomic<int> sampleStorage_{ (int)ttvst::codec::SampleStorage::float32 };
+    juce::AudioBuffer<float> decodeScratch_;   // 16-bit/streamed storage widened per run, unity runs on a double bus
+    juce::AudioBuffer<float> stemRenderFloat_;    // every source channel of the block, before the bus mix
+    juce::AudioBuffer<double> stemRenderDouble_;
+    std::vector<int64_t> gatherIndex_;         // per-sample source index/fraction of a render run,
+    std::vector<double> gatherFrac_;           // shared by all channels
+    std::array<std::atomic<float>, kMaxStems> stemGain_{};
+    std::array<float, kMaxStems> stemGainInUse_{};   // audio thread, ramped towards stemGain_
+
+    // Audio-thread state mirrored once per block so getStateInformation can read it
+    std::atomic<double> playheadSnapshot_{ 0.0 };
+    std::atomic<bool> motorSnapshot_{ false };
+    std::atomic<bool> loopSnapshot_{ true };
+    std::atomic<int> loopStartSnapshot_{ 0 };
+    std::atomic<int> loopLengthSnapshot_{ 0 };
+    std::atomic<int> deckSnapshot_{ 0 };
+    std::atomic<double> motorSpeedSnapshot_{ 1.0 };
+    std::atomic<int> keylockSnapshot_{ 0 };
+    std::atomic<int> samplerSnapshot_{ ttvst::sampler::off };
+    std::atomic<int> positionSourceSnapshot_{ pitchWheelSource };
+    std::atomic<bool> timecodeSignalSnapshot_{ false };
+    std::atomic<bool> timecodeLockedSnapshot_{ false };
+    std::atomic<double> timecodeSpeedSnapshot_{ 0.0 };
+
     ttvst::MidiMessageManager midiLog_;
-    std::optional<int> lastOffset, afterRenderOffset, preRenderOffset;
-    std::optional<double> lastValue, afterRenderValue, preRenderValue;
-    std::vector<double> offsets_, values_, ratios_;
-    enum block { pre, render, after };
+    ttvst::TransportCommandQueue transport_;
+    std::array<ttvst::TransportCommand, ttvst::TransportCommandQueue::capacity> blockCommands_{};
+    ttvst::midi::ActionMap midiActions_;   // filled in the constructor, read-only after
+    ttvst::ump::PositionDecoder umpPosition_;   // MIDI 2.0 platter packets, set up with midiActions_
+    std::vector<double> ratios_;
+    std::vector<int64_t> phaseSteps_;   // ratios_ as PlayheadPhase increments
+    ttvst::splines::SlidingSpline scratchSpline_;   // pitch-wheel knots at absolute sample times
+    std::atomic<uint32_t> knotOverflows_{ 0 };
+    int64_t blockTime_ = 0;                          // absolute time of the current block's first sample
+    int scratchLatency_ = 0;                         // render delay behind blockTime_ in use
+    std::atomic<int> scratchWindow_{ 1 };
+    int preparedBlockSize_ = 0;
+    ttvst::ScopeRecorder scopeRecorder_;
+    ttvst::TripleBuffer<ttvst::ScopeFrame> scope_;
+    ttvst::tap::SignalTapRecorder signalTap_;
+    int tapKnots_ = 0, tapPosition_ = 0, tapRatio_ = 0, tapOutput_ = 0;   // stream ids
+    int tapGovernor_ = 0;
+    std::vector<double> tapScratch_;    // stream data staged for SignalTapRecorder::write
+    ttvst::SetRecorder setRecorder_;    // main output to disk, pushed at the end of every block
+    ttvst::LoadGovernor governor_;
+    int governorLevel_ = ttvst::LoadGovernor::full;   // this block's
+    int telemetryBlocks_ = 0;                         // counts blocks at sparseTelemetry
+    std::atomic<int> interpolation_{ ttvst::interp::sinc };
+    int interpInUse_ = ttvst::interp::sinc;           // this block's, after the governor's cap
     double hostSampleRate_ = 44100.0;  // set in prepareToPlay
     //int64_t playhead_ = 0;
     //int64_t playheadReversed_ = 0;// current read position in source samples
-    double playhead_ = 0;
+    ttvst::PlayheadPhase playhead_;   // source position, 32.32 fixed point
     double I_sim = 0.0;
     double I_ext = 0.0;
     double beta = 0.0;
+    // audio-thread owned, only changed through transport_
     bool motorState = false;
     bool loop_ = true;
-    bool afterRender = false;
-    bool preRender = false;
-    juce::AudioBuffer<float> lastBlock_;
-    juce::MidiBuffer lastMidi_;
-    bool haveLastMidi_ = false;
-    bool haveLast_ = false;
+    int loopStart_ = 0;
+    int loopLength_ = 0;
+    juce::AudioBuffer<float> loopSeam_;                // see buildLoopSeam
+    std::array<float, kLoopXfade> loopFade_{};         // raised-cosine fade-in, built in prepareToPlay
+    int deck_ = 0;
+    double motorSpeed_ = 1.0;
+    bool reverse_ = false;
+    int brakeLeft_ = 0;             // samples of spin-down to go, 0 = not braking
+    int brakeLength_ = 0;           // kBrakeSeconds at the host rate
+    std::array<std::array<double, ttvst::midi::ActionMap::kNumHotCues>, kNumDecks> hotCues_{};   // source samples, < 0 = empty
+    std::array<uint64_t, kNumDecks> deckGeneration_{};   // DeckTrack::generation the cues belong to
+    int keylockMode_ = ttvst::KeylockEngine::off;
+    int samplerMode_ = ttvst::sampler::off;
+    ttvst::sampler::VoicePool voices_;
+    juce::AudioBuffer<float> voiceRenderFloat_;    // one voice's segment before it is mixed in
+    juce::AudioBuffer<double> voiceRenderDouble_;
+    std::vector<float> voiceGain_;                 // its envelope over the segment
+    bool keylockActive_ = false;
+    ttvst::KeylockEngine keylock_;
+    juce::AudioBuffer<float> keylockXfade_;
+    juce::AudioBuffer<float> keylockOut_;     // stretcher output when the host renders in double
+    int positionSource_ = pitchWheelSource;
+    ttvst::timecode::Decoder timecode_;
+    ttvst::timecode::Decoder::Status timecodeStatus_;
+    std::vector<double> timecodeCycles_;      // platter movement per sample, carrier cycles
+    juce::AudioBuffer<float> timecodeIn_;     // input widened/narrowed to float for the decoder
     juce::LinearInterpolator interp;
 
 };
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    RenderKernels.h
+    Gather loops of the varispeed renderer, for planar and interleaved tracks,
+    and the table the renderer picks them from.
+    No JUCE here: Benchmarks/RenderBench.cpp times these very functions.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include "Interpolators.h"
+#include "PlayheadPhase.h"
+#include "SampleCodec.h"   // TTVST_SSE2
+
+namespace ttvst::render {
+
+    /**
+     * Planar tracks: one pointer per output channel (at track sample 0), and each
+     * channel gathered on its own from the shared index/fraction arrays.
+     * The generic loops; selectKernels swaps in the fixed-channel ones below where
+     * they measure faster.
+     */
+    template <typename Reader, typename FloatType>
+    void gatherPlanar(const float* const* chans, int numCh, const int64_t* index, const double* frac,
+        FloatType* const* out, int from, int to) noexcept
+    {
+        for (int ch = 0; ch < numCh; ch++) {
+            const float* src = chans[ch];
+            FloatType* dst = out[ch];
+            for (int i = from; i < to; i++)
+                dst[i] = Reader::template read<FloatType>(src + index[i], frac[i]);
+        }
+    }
+
+    /**
+     * Constant ratio (the motor off unity, nothing scratching): the position is an
+     * arithmetic series, so each channel steps it in its own loop and the index/fraction
+     * arrays are never written. phase and step are PlayheadPhase raw values.
+     */
+    template <typename Reader, typename FloatType>
+    void gatherConstant(const float* const* chans, int numCh, int64_t phase, int64_t step,
+        FloatType* const* out, int from, int to) noexcept
+    {
+        for (int ch = 0; ch < numCh; ch++) {
+            const float* src = chans[ch];
+            FloatType* dst = out[ch];
+            PlayheadPhase p{ phase };
+            for (int i = from; i < to; i++) {
+                dst[i] = Reader::template read<FloatType>(src + p.index(), p.frac<double>());
+                p += step;
+            }
+        }
+    }
+
+    /**
+     * Every channel's sample at one position. A multi-tap reader computes its weights
+     * once and applies them to each channel, weights and sum in FloatType (a double
+     * bus keeps its double-precision interpolation); linear, or a single channel, has
+     * nothing to share and reads directly.
+     * kChannels is 1 or 2, or 0 for numCh at run time.
+     */
+    template <typename Reader, int kChannels, typename FloatType>
+    inline void readChannels(const float* const* chans, int numCh, int64_t index, double frac,
+        FloatType* const* out, int i) noexcept
+    {
+        constexpr int kTaps = Reader::kBefore + Reader::kAfter + 1;
+        const int n = kChannels > 0 ? kChannels : numCh;
+        if constexpr (kChannels == 1 || kTaps <= 2) {
+            for (int ch = 0; ch < n; ch++)
+                out[ch][i] = Reader::template read<FloatType>(chans[ch] + index, frac);
+        }
+        else {
+            FloatType w[kTaps];
+            Reader::weights(frac, w);
+            for (int ch = 0; ch < n; ch++) {
+                const float* s = chans[ch] + index - Reader::kBefore;
+                FloatType acc = 0;
+                for (int k = 0; k < kTaps; ++k)
+                    acc += w[k] * (FloatType)s[k];
+                out[ch][i] = acc;
+            }
+        }
+    }
+
+    // gatherPlanar with the channel count fixed at compile time: channel and tap loops unroll
+    template <typename Reader, int kChannels, typename FloatType>
+    void gatherPlanarFixed(const float* const* chans, int numCh, const int64_t* index, const double* frac,
+        FloatType* const* out, int from, int to) noexcept
+    {
+        for (int i = from; i < to; i++)
+            readChannels<Reader, kChannels>(chans, numCh, index[i], frac[i], out, i);
+    }
+
+    // gatherConstant, likewise
+    template <typename Reader, int kChannels, typename FloatType>
+    void gatherConstantFixed(const float* const* chans, int numCh, int64_t phase, int64_t step,
+        FloatType* const* out, int from, int to) noexcept
+    {
+        PlayheadPhase p{ phase };
+        for (int i = from; i < to; i++) {
+            readChannels<Reader, kChannels>(chans, numCh, p.index(), p.frac<double>(), out, i);
+            p += step;
+        }
+    }
+
+    // Weighted sum of kTaps consecutive frames into lanes[0 .. Stride)
+    template <int kTaps, int Stride>
+    inline void accumulateFrames(const float* f, const float* w, float* lanes) noexcept
+    {
+       #if TTVST_SSE2
+        if constexpr (Stride == 4) {
+            // one aligned load is one tap of all four channels
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kTaps; ++k)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_load_ps(f + 4 * k)));
+            _mm_storeu_ps(lanes, acc);
+        }
+        else {
+            // one load is two taps of a stereo pair; fold the halves at the end
+            static_assert(kTaps % 2 == 0, "stereo frames are read two taps at a time");
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kTaps; k += 2)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set_ps(w[k + 1], w[k + 1], w[k], w[k]), _mm_loadu_ps(f + 2 * k)));
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            _mm_storel_pi(reinterpret_cast<__m64*>(lanes), acc);
+        }
+       #else
+        for (int c = 0; c < Stride; ++c)
+            lanes[c] = 0.0f;
+        for (int k = 0; k < kTaps; ++k)
+            for (int c = 0; c < Stride; ++c)
+                lanes[c] += w[k] * f[k * Stride + c];
+       #endif
+    }
+
+    /**
+     * Interleaved tracks: frames of Stride floats (2 or 4), frame 0 at `frames`, which is
+     * 16-byte aligned. Every tap of every channel comes from one frame load; output
+     * channel ch takes frame slot lane[ch]. Sums in float whatever FloatType is.
+     */
+    template <typename Reader, int Stride, typename FloatType>
+    void gatherFrames(const float* frames, const int* lane, int numCh, const int64_t* index, const double* frac,
+        FloatType* const* out, int from, int to) noexcept
+    {
+        static_assert(Stride == 2 || Stride == 4, "frames are a stereo pair or a 4-channel quad");
+        constexpr int kTaps = Reader::kBefore + Reader::kAfter + 1;
+        float w[kTaps];
+        alignas(16) float lanes[4];
+
+        for (int i = from; i < to; i++) {
+            Reader::weights(frac[i], w);
+            accumulateFrames<kTaps, Stride>(frames + (index[i] - Reader::kBefore) * Stride, w, lanes);
+            for (int ch = 0; ch < numCh; ch++)
+                out[ch][i] = (FloatType)lanes[lane[ch]];
+        }
+    }
+
+    template <typename FloatType>
+    struct Kernels
+    {
+        void (*gather)(const float* const*, int, const int64_t*, const double*, FloatType* const*, int, int) noexcept;
+        void (*constant)(const float* const*, int, int64_t, int64_t, FloatType* const*, int, int) noexcept;
+        void (*frames2)(const float*, const int*, int, const int64_t*, const double*, FloatType* const*, int, int) noexcept;
+        void (*frames4)(const float*, const int*, int, const int64_t*, const double*, FloatType* const*, int, int) noexcept;
+    };
+
+    // kFixedGather / kFixedConstant: the fixed-channel loop, else the generic one
+    template <typename Reader, int kChannels, bool kFixedGather, bool kFixedConstant, typename FloatType>
+    constexpr Kernels<FloatType> kernelsFor() noexcept
+    {
+        Kernels<FloatType> k{};
+        if constexpr (kFixedGather) k.gather = &gatherPlanarFixed<Reader, kChannels, FloatType>;
+        else k.gather = &gatherPlanar<Reader, FloatType>;
+        if constexpr (kFixedConstant) k.constant = &gatherConstantFixed<Reader, kChannels, FloatType>;
+        else k.constant = &gatherConstant<Reader, FloatType>;
+        k.frames2 = &gatherFrames<Reader, 2, FloatType>;
+        k.frames4 = &gatherFrames<Reader, 4, FloatType>;
+        return k;
+    }
+
+    /**
+     * The loops for an interpolator (interp::Kind) and channel count, looked up once
+     * per render call so nothing inside a run branches on either.
+     * A fixed-channel loop is listed only where Benchmarks/RenderBench.cpp showed it
+     * faster on repeated runs. Everything else stays generic, because some fixed
+     * loops ran slower than the generic ones (stereo sinc gather, 1-channel hermite).
+     */
+    template <typename FloatType>
+    const Kernels<FloatType>& selectKernels(int kind, int numCh) noexcept
+    {
+        using namespace interp;
+        static constexpr Kernels<FloatType> table[kNumKinds][3] = {
+            { kernelsFor<Linear, 1, false, false, FloatType>(),
+              kernelsFor<Linear, 2, true, true, FloatType>(),
+              kernelsFor<Linear, 0, false, true, FloatType>() },
+            { kernelsFor<Hermite, 1, false, false, FloatType>(),
+              kernelsFor<Hermite, 2, false, false, FloatType>(),
+              kernelsFor<Hermite, 0, true, true, FloatType>() },
+            { kernelsFor<Sinc, 1, false, true, FloatType>(),
+              kernelsFor<Sinc, 2, false, true, FloatType>(),
+              kernelsFor<Sinc, 0, false, true, FloatType>() },
+        };
+        const int k = kind >= 0 && kind < kNumKinds ? kind : linear;
+        return table[k][numCh == 1 ? 0 : numCh == 2 ? 1 : 2];
+    }
+
+} // namespace ttvst::render
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    SampleCodec.h
+    Compact in-RAM sample formats (16-bit PCM, IEEE half) and their
+    float widening/narrowing. Decode runs on the audio thread, encode on
+    the loader thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define TTVST_SSE2 1
+ #include <emmintrin.h>
+ #if defined(__F16C__) || defined(__AVX2__)
+  #define TTVST_F16C 1
+  #include <immintrin.h>
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define TTVST_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace ttvst::codec {
+
+    // How a LoadedAudio keeps its samples in RAM
+    enum class SampleStorage : int
+    {
+        float32 = 0,    // full precision, mastering-grade renders
+        int16,          // 16-bit PCM, ~96 dB, half the memory
+        float16,        // IEEE half, more headroom than int16 near full scale
+        float32Frames,  // full precision, channels interleaved per frame (see LoadedAudio::frames). Opt-in:
+                        // faster for 3-4 channel tracks, and for stereo under sinc or jumpy
+                        // scratching; stereo under linear/Hermite reads slower (Benchmarks/RenderBench)
+        streamed        // left on disk, decoded in chunks around the playhead (see ChunkStream)
+    };
+
+    inline int bytesPerSample(SampleStorage s) noexcept
+    {
+        return s == SampleStorage::int16 || s == SampleStorage::float16 ? 2 : 4;
+    }
+
+    // Stored as 16-bit words, widened by readSpan
+    inline bool isPacked16(SampleStorage s) noexcept
+    {
+        return s == SampleStorage::int16 || s == SampleStorage::float16;
+    }
+
+    // No pointer into the samples: the renderer reads spans into a window first
+    inline bool isWindowed(SampleStorage s) noexcept
+    {
+        return isPacked16(s) || s == SampleStorage::streamed;
+    }
+
+    //==============================================================================
+    // IEEE 754 binary16 <-> binary32, scalar reference versions
+
+    inline float halfToFloat(uint16_t h) noexcept
+    {
+        const uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+        uint32_t exp = (h >> 10) & 0x1fu;
+        uint32_t mant = h & 0x3ffu;
+        uint32_t bits;
+
+        if (exp == 0)
+        {
+            if (mant == 0) bits = sign;                       // +-0
+            else
+            {
+                // subnormal: normalise
+                exp = 127 - 15 + 1;
+                while ((mant & 0x400u) == 0) { mant <<= 1; --exp; }
+                mant &= 0x3ffu;
+                bits = sign | (exp << 23) | (mant << 13);
+            }
+        }
+        else if (exp == 0x1f) bits = sign | 0x7f800000u | (mant << 13);   // inf/nan
+        else                  bits = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    inline uint16_t floatToHalf(float f) noexcept
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+
+        const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+        const int32_t exp = (int32_t)((bits >> 23) & 0xffu) - 127 + 15;
+        uint32_t mant = bits & 0x7fffffu;
+
+        if (((bits >> 23) & 0xffu) == 0xffu)                       // inf/nan
+            return (uint16_t)(sign | 0x7c00u | (mant ? 0x200u : 0u));
+        if (exp >= 0x1f)                                            // overflow -> inf
+            return (uint16_t)(sign | 0x7c00u);
+        if (exp <= 0)
+        {
+            if (exp < -10) return sign;                             // underflow -> 0
+            mant |= 0x800000u;                                      // subnormal
+            const int shift = 14 - exp;
+            uint32_t half = mant >> shift;
+            const uint32_t rem = mant & ((1u << shift) - 1u);
+            const uint32_t mid = 1u << (shift - 1);
+            if (rem > mid || (rem == mid && (half & 1u))) ++half;   // round to nearest even
+            return (uint16_t)(sign | half);
+        }
+
+        uint32_t half = ((uint32_t)exp << 10) | (mant >> 13);
+        const uint32_t rem = mant & 0x1fffu;
+        if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) ++half; // may carry into exp, that's correct
+        return (uint16_t)(sign | half);
+    }
+
+    //==============================================================================
+    // Block conversions. Decode is the hot one (audio thread), encode runs once per load.
+
+    // One scale both ways, so -1.0 round-trips; +1.0 clamps to 32767
+    constexpr float kInt16Range = 32768.0f;
+    constexpr float kInt16Scale = 1.0f / kInt16Range;
+
+    inline void decodeInt16(const int16_t* src, float* dst, int n) noexcept
+    {
+        int i = 0;
+#if TTVST_SSE2
+        const __m128 scale = _mm_set1_ps(kInt16Scale);
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            // widen by placing each int16 in the top half of a lane, then arithmetic shift down
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+#elif TTVST_NEON
+        for (; i + 8 <= n; i += 8)
+        {
+            const int16x8_t x = vld1q_s16(src + i);
+            vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), kInt16Scale));
+            vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), kInt16Scale));
+        }
+#endif
+        for (; i < n; ++i)
+            dst[i] = (float)src[i] * kInt16Scale;
+    }
+
+    inline void encodeInt16(const float* src, int16_t* dst, int n) noexcept
+    {
+        int i = 0;
+#if TTVST_SSE2
+        const __m128 scale = _mm_set1_ps(kInt16Range);
+        for (; i + 8 <= n; i += 8)
+        {
+            // cvtps rounds to nearest, packs saturates to [-32768, 32767]
+            const __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+            const __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            const float v = std::clamp(src[i] * kInt16Range, -32768.0f, 32767.0f);
+            dst[i] = (int16_t)std::lrint(v);
+        }
+    }
+
+    inline void decodeHalf(const uint16_t* src, float* dst, int n) noexcept
+    {
+        int i = 0;
+#if TTVST_F16C
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(x));
+        }
+#elif TTVST_NEON && defined(__aarch64__)
+        for (; i + 4 <= n; i += 4)
+            vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+#endif
+        for (; i < n; ++i)
+            dst[i] = halfToFloat(src[i]);
+    }
+
+    inline void encodeHalf(const float* src, uint16_t* dst, int n) noexcept
+    {
+        int i = 0;
+#if TTVST_F16C
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+        }
+#endif
+        for (; i < n; ++i)
+            dst[i] = floatToHalf(src[i]);
+    }
+
+} // namespace ttvst::codec
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SamplerVoices.h
+    Fixed pool of one-shot / gated voices that play regions of the loaded track
+    from MIDI notes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "PlayheadPhase.h"
+
+namespace ttvst::sampler {
+
+    enum Mode : int { off = 0, oneShot, gated, kNumModes };
+
+    struct Voice
+    {
+        PlayheadPhase ph;               // read position, advanced by the render
+        PlayheadPhase lo, hi;           // the region it plays, [lo, hi)
+        uint64_t generation = 0;        // DeckTrack::generation it was started on; a new load ends it
+        int deck = 0;
+        int note = -1;
+        float gain = 0.0f;              // velocity
+        float level = 0.0f;             // envelope, moves toward target by 1 / kFade per sample
+        float target = 0.0f;
+        uint64_t order = 0;             // start order: the oldest is stolen first
+        bool active = false;
+        bool held = false;              // gated and the note is still down
+    };
+
+    /**
+     * Voices live in a fixed array sized with the processor. At most kMaxVoices sound at
+     * full level: one more note sends the oldest of them into its release and takes a
+     * free slot, the extra slots holding those tails. With every slot busy the quietest
+     * releasing voice is cut. A note already sounding is choked by its retrigger, the
+     * usual pad behaviour for juggling a cue.
+     * Starting, releasing and stealing only write this array: no allocation, no lock.
+     * Audio thread only.
+     */
+    class VoicePool
+    {
+    public:
+        static constexpr int kMaxVoices = 16;
+        static constexpr int kNumSlots = kMaxVoices + 8;
+        static constexpr int kFade = 64;    // attack, release and steal ramp, samples
+
+        void start(int note, float velocity, int deck, uint64_t generation,
+            PlayheadPhase lo, PlayheadPhase hi, bool gated) noexcept
+        {
+            int sounding = 0;
+            Voice* oldest = nullptr;
+            for (auto& v : voices_) {
+                if (!v.active || v.target == 0.0f) continue;
+                if (v.note == note) { v.target = 0.0f; continue; }   // choke
+                ++sounding;
+                if (oldest == nullptr || v.order < oldest->order) oldest = &v;
+            }
+            if (sounding >= kMaxVoices && oldest != nullptr)
+                oldest->target = 0.0f;
+
+            Voice* slot = nullptr;
+            for (auto& v : voices_) {
+                if (!v.active) { slot = &v; break; }
+                if (v.target == 0.0f && (slot == nullptr || v.level < slot->level)) slot = &v;
+            }
+            if (slot == nullptr) return;   // cannot happen: kNumSlots > kMaxVoices
+
+            Voice v;
+            v.ph = lo;
+            v.lo = lo;
+            v.hi = hi;
+            v.generation = generation;
+            v.deck = deck;
+            v.note = note;
+            v.gain = velocity;
+            v.target = 1.0f;
+            v.order = ++counter_;
+            v.active = true;
+            v.held = gated;
+            *slot = v;
+        }
+
+        // Note off: held (gated) voices on this note fade out
+        void release(int note) noexcept
+        {
+            for (auto& v : voices_)
+                if (v.active && v.held && v.note == note) {
+                    v.held = false;
+                    v.target = 0.0f;
+                }
+        }
+
+        void releaseAll() noexcept
+        {
+            for (auto& v : voices_) {
+                v.held = false;
+                v.target = 0.0f;
+            }
+        }
+
+        // Every voice off at once, no fade: their tracks are gone
+        void clear() noexcept
+        {
+            for (auto& v : voices_) v.active = false;
+        }
+
+        bool anyActive() const noexcept
+        {
+            for (const auto& v : voices_)
+                if (v.active) return true;
+            return false;
+        }
+
+        std::array<Voice, kNumSlots>& voices() noexcept { return voices_; }
+
+        // Gains for the voice's next n samples; returns how many it plays before its
+        // release reaches zero, and ends it then.
+        static int envelope(Voice& v, float* gains, int n) noexcept
+        {
+            constexpr float step = 1.0f / (float)kFade;
+            for (int i = 0; i < n; ++i) {
+                if (v.level < v.target) v.level = v.level + step > v.target ? v.target : v.level + step;
+                else if (v.level > v.target) v.level = v.level - step < v.target ? v.target : v.level - step;
+                if (v.level <= 0.0f && v.target == 0.0f) {
+                    v.active = false;
+                    return i;
+                }
+                gains[i] = v.level * v.gain;
+            }
+            return n;
+        }
+
+    private:
+        std::array<Voice, kNumSlots> voices_{};
+        uint64_t counter_ = 0;
+    };
+
+} // namespace ttvst::sampler
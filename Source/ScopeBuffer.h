@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    ScopeBuffer.h
+    Wait-free triple buffer and the scratch-curve snapshots sent through it.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ttvst {
+
+    /**
+     * One writer, one reader, neither ever waits. The writer fills back() and publishes;
+     * the reader picks up the newest published slot. Slots in between are overwritten,
+     * the reader only ever sees the latest complete one.
+     */
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        // Writer side
+        T& back() noexcept { return slots_[(size_t)back_]; }
+
+        void publish() noexcept
+        {
+            back_ = state_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+        }
+
+        // Reader side: the newest published slot, or nullptr if nothing new since the last call.
+        // The returned slot stays untouched by the writer until the next acquire().
+        const T* acquire() noexcept
+        {
+            if ((state_.load(std::memory_order_relaxed) & kFresh) == 0)
+                return nullptr;
+            front_ = state_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+            return &slots_[(size_t)front_];
+        }
+
+    private:
+        static constexpr int kIndex = 3;
+        static constexpr int kFresh = 4;
+
+        std::array<T, 3> slots_{};
+        int back_ = 0;                    // writer owned
+        int front_ = 1;                   // reader owned
+        std::atomic<int> state_{ 2 };     // the middle slot, plus kFresh once published
+    };
+
+    // The scratch curve as the editor draws it: a rolling window of decimated columns
+    struct ScopeFrame
+    {
+        static constexpr int kPoints = 512;        // columns, oldest first
+        static constexpr int kDecimation = 64;     // samples per column
+        static constexpr int kMaxKnots = 256;
+
+        int64_t endTime = 0;       // spline time just after the newest column
+        int numPoints = 0;
+        std::array<float, kPoints> position{};     // platter travel, samples, at the end of each column
+        std::array<float, kPoints> ratio{};        // mean playback ratio over each column
+        int numKnots = 0;                          // newest kMaxKnots, oldest first
+        std::array<int64_t, kMaxKnots> knotTime{};
+        std::array<float, kMaxKnots> knotValue{};
+    };
+
+    /**
+     * Audio-thread side of the scope: decimates the per-sample ratio into columns,
+     * keeps rolling histories and publishes them whenever a column completes.
+     * Costs a few adds per sample and one copy of the window per published frame.
+     */
+    class ScopeRecorder
+    {
+    public:
+        void reset() noexcept
+        {
+            numPoints_ = numKnots_ = writePoint_ = writeKnot_ = 0;
+            bucketSum_ = 0.0;
+            bucketCount_ = 0;
+        }
+
+        // Spline time and value of a knot
+        void addKnot(int64_t t, double value) noexcept
+        {
+            knotTime_[(size_t)writeKnot_] = t;
+            knotValue_[(size_t)writeKnot_] = (float)value;
+            writeKnot_ = (writeKnot_ + 1) % ScopeFrame::kMaxKnots;
+            if (numKnots_ < ScopeFrame::kMaxKnots) ++numKnots_;
+        }
+
+        // Position the next pushed sample starts from (the curve's, while it drives the platter)
+        void setPosition(double p) noexcept { position_ = p; }
+
+        // n samples of ratio from spline time t0; ratio == nullptr means constantRatio throughout
+        void push(const double* ratio, double constantRatio, int64_t t0, int n) noexcept
+        {
+            time_ = t0;
+            for (int i = 0; i < n; ++i) {
+                const double r = ratio != nullptr ? ratio[i] : constantRatio;
+                position_ += r;
+                bucketSum_ += r;
+                if (++bucketCount_ == ScopeFrame::kDecimation) {
+                    columnPosition_[(size_t)writePoint_] = (float)position_;
+                    columnRatio_[(size_t)writePoint_] = (float)(bucketSum_ / ScopeFrame::kDecimation);
+                    writePoint_ = (writePoint_ + 1) % ScopeFrame::kPoints;
+                    if (numPoints_ < ScopeFrame::kPoints) ++numPoints_;
+                    bucketSum_ = 0.0;
+                    bucketCount_ = 0;
+                    columnsAdded_ = true;
+                }
+            }
+            time_ += n;
+        }
+
+        void publishTo(TripleBuffer<ScopeFrame>& out) noexcept
+        {
+            if (!columnsAdded_) return;
+            columnsAdded_ = false;
+
+            ScopeFrame& f = out.back();
+            f.endTime = time_ - bucketCount_;
+            f.numPoints = numPoints_;
+            const int firstPoint = (writePoint_ - numPoints_ + ScopeFrame::kPoints) % ScopeFrame::kPoints;
+            for (int i = 0; i < numPoints_; ++i) {
+                const size_t src = (size_t)((firstPoint + i) % ScopeFrame::kPoints);
+                f.position[(size_t)i] = columnPosition_[src];
+                f.ratio[(size_t)i] = columnRatio_[src];
+            }
+            f.numKnots = numKnots_;
+            const int firstKnot = (writeKnot_ - numKnots_ + ScopeFrame::kMaxKnots) % ScopeFrame::kMaxKnots;
+            for (int i = 0; i < numKnots_; ++i) {
+                const size_t src = (size_t)((firstKnot + i) % ScopeFrame::kMaxKnots);
+                f.knotTime[(size_t)i] = knotTime_[src];
+                f.knotValue[(size_t)i] = knotValue_[src];
+            }
+            out.publish();
+        }
+
+    private:
+        std::array<float, ScopeFrame::kPoints> columnPosition_{}, columnRatio_{};
+        std::array<int64_t, ScopeFrame::kMaxKnots> knotTime_{};
+        std::array<float, ScopeFrame::kMaxKnots> knotValue_{};
+        int numPoints_ = 0, writePoint_ = 0;
+        int numKnots_ = 0, writeKnot_ = 0;
+        double position_ = 0.0;
+        double bucketSum_ = 0.0;
+        int bucketCount_ = 0;
+        int64_t time_ = 0;
+        bool columnsAdded_ = false;
+    };
+
+} // namespace ttvst
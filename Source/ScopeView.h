@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ScopeView.h
+    Live plot of the scratch curve published through ScopeBuffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include "ScopeBuffer.h"
+
+namespace ttvst {
+
+    // Platter position with its pitch-wheel knots on top, playback ratio below; newest at the right
+    class ScopeView : public juce::Component
+    {
+    public:
+        // Message thread. The frame must stay valid until the next call (TripleBuffer::acquire does)
+        void setFrame(const ScopeFrame* frame)
+        {
+            frame_ = frame;
+            repaint();
+        }
+
+        void paint(juce::Graphics& g) override
+        {
+            g.fillAll(juce::Colours::black);
+            g.setColour(juce::Colours::darkgrey);
+            g.drawRect(getLocalBounds());
+
+            if (frame_ == nullptr || frame_->numPoints < 2) return;
+            const ScopeFrame& f = *frame_;
+
+            auto area = getLocalBounds().toFloat().reduced(2.0f);
+            auto ratioArea = area.removeFromBottom(area.getHeight() / 3.0f);
+            const float dx = area.getWidth() / (float)(ScopeFrame::kPoints - 1);
+            auto xOf = [&](float column) { return area.getRight() - ((float)(f.numPoints - 1) - column) * dx; };
+
+            // knots older than the window are skipped, the ones ahead of the render shown
+            auto knotColumn = [&](int k) {
+                return (float)(f.numPoints - 1) + (float)(f.knotTime[(size_t)k] - f.endTime) / (float)ScopeFrame::kDecimation;
+            };
+
+            float lo = f.position[0], hi = f.position[0];
+            for (int i = 0; i < f.numPoints; ++i) {
+                lo = std::min(lo, f.position[(size_t)i]);
+                hi = std::max(hi, f.position[(size_t)i]);
+            }
+            for (int k = 0; k < f.numKnots; ++k)
+                if (knotColumn(k) >= 0.0f) {
+                    lo = std::min(lo, f.knotValue[(size_t)k]);
+                    hi = std::max(hi, f.knotValue[(size_t)k]);
+                }
+            const float pad = std::max(1.0f, (hi - lo) * 0.05f);
+            lo -= pad;
+            hi += pad;
+            auto yOf = [&](float p) { return juce::jmap(p, lo, hi, area.getBottom(), area.getY()); };
+
+            juce::Path position;
+            for (int i = 0; i < f.numPoints; ++i) {
+                const float x = xOf((float)i), y = yOf(f.position[(size_t)i]);
+                if (i == 0) position.startNewSubPath(x, y);
+                else position.lineTo(x, y);
+            }
+            g.setColour(juce::Colours::lightgreen);
+            g.strokePath(position, juce::PathStrokeType(1.0f));
+
+            g.setColour(juce::Colours::orange);
+            for (int k = 0; k < f.numKnots; ++k) {
+                const float c = knotColumn(k);
+                if (c < 0.0f) continue;
+                const float x = juce::jmin(xOf(c), area.getRight());
+                g.fillEllipse(x - 2.0f, yOf(f.knotValue[(size_t)k]) - 2.0f, 4.0f, 4.0f);
+            }
+
+            // ratio around zero, at least +-1.5 so the motor at unity sits inside
+            float range = 1.5f;
+            for (int i = 0; i < f.numPoints; ++i)
+                range = std::max(range, std::abs(f.ratio[(size_t)i]));
+            auto yOfRatio = [&](float r) { return juce::jmap(r, -range, range, ratioArea.getBottom(), ratioArea.getY()); };
+
+            g.setColour(juce::Colours::darkgrey);
+            g.drawHorizontalLine((int)yOfRatio(0.0f), ratioArea.getX(), ratioArea.getRight());
+
+            juce::Path ratio;
+            for (int i = 0; i < f.numPoints; ++i) {
+                const float x = xOf((float)i), y = yOfRatio(f.ratio[(size_t)i]);
+                if (i == 0) ratio.startNewSubPath(x, y);
+                else ratio.lineTo(x, y);
+            }
+            g.setColour(juce::Colours::skyblue);
+            g.strokePath(ratio, juce::PathStrokeType(1.0f));
+        }
+
+    private:
+        const ScopeFrame* frame_ = nullptr;
+    };
+
+} // namespace ttvst
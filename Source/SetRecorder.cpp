@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    SetRecorder.cpp
+
+  ==============================================================================
+*/
+
+#include "SetRecorder.h"
+
+namespace ttvst {
+
+    bool SetRecorder::start(const juce::File& folder, const juce::String& baseName, Format format,
+        double sampleRate, int numChannels, double rotateMinutes)
+    {
+        stop();
+        if (sampleRate <= 0.0 || numChannels <= 0) return false;
+
+        if (ring_.empty()) ring_.assign((size_t)kRingFrames * kMaxChannels, 0.0f);
+
+        if (format == Format::flac) format_ = std::make_unique<juce::FlacAudioFormat>();
+        else                        format_ = std::make_unique<juce::WavAudioFormat>();
+        folder_ = folder;
+        baseName_ = baseName;
+        sampleRate_ = sampleRate;
+        numChannels_ = juce::jmin(numChannels, kMaxChannels);
+        partFrames_ = juce::jmax<int64_t>(1, (int64_t)(rotateMinutes * 60.0 * sampleRate));
+        planar_.setSize(numChannels_, 4096);
+
+        written_.store(0);
+        dropped_.store(0);
+        writeError_.store(false);
+        folder_.createDirectory();
+        if (!openPart(1)) return false;
+
+        // anything left from an earlier run belongs to the old file
+        read_.store(write_.load(std::memory_order_acquire), std::memory_order_release);
+        gapRead_.store(gapWrite_.load(std::memory_order_acquire), std::memory_order_release);
+        gapFrames_ = 0;
+        armed_.store(true, std::memory_order_seq_cst);
+        startThread(juce::Thread::Priority::normal);
+        return true;
+    }
+
+    void SetRecorder::stop()
+    {
+        if (!armed_.exchange(false, std::memory_order_seq_cst) && writer_ == nullptr) return;
+        while (inPush_.load(std::memory_order_seq_cst))   // a block that saw us armed: one copy at most
+            juce::Thread::yield();
+        stopThread(4000);
+        drain(false);
+        writer_.reset();   // flushes and finishes the header
+        if (const auto dropped = dropped_.load())
+            DBG("SetRecorder: " << (juce::int64)dropped << " samples dropped");
+    }
+
+    void SetRecorder::run()
+    {
+        while (!threadShouldExit()) {
+            drain(true);
+            wait(20);
+        }
+    }
+
+    bool SetRecorder::openPart(int number)
+    {
+        writer_.reset();
+
+        const auto file = folder_.getNonexistentChildFile(baseName_ + " part " + juce::String(number),
+            format_->getFileExtensions()[0], false);
+        auto stream = file.createOutputStream();
+        if (stream == nullptr) {
+            writeError_.store(true);
+            return false;
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format_->createWriterFor(stream.get(), sampleRate_,
+            (unsigned int)numChannels_, kBitsPerSample, {}, 0));
+        if (writer == nullptr) {
+            writeError_.store(true);
+            return false;
+        }
+        stream.release();   // the writer owns it now
+
+        writer_ = std::move(writer);
+        framesInPart_ = 0;
+        part_.store(number, std::memory_order_relaxed);
+        return true;
+    }
+
+    void SetRecorder::drain(bool onWriterThread)
+    {
+        // a part that failed to open is retried once per pass; until then the audio is dropped
+        if (writer_ == nullptr && format_ != nullptr)
+            openPart(part_.load(std::memory_order_relaxed) + 1);
+
+        const int numCh = numChannels_;
+        const int slice = planar_.getNumSamples();
+        for (;;) {
+            if (onWriterThread && threadShouldExit()) return;   // stop() drains the rest
+
+            const int64_t r = read_.load(std::memory_order_relaxed);
+            const int64_t w = write_.load(std::memory_order_acquire);
+            const int64_t g = gapRead_.load(std::memory_order_relaxed);
+            const bool gapPending = g != gapWrite_.load(std::memory_order_acquire);
+            const Gap gap = gapPending ? gaps_[(size_t)(g & (kMaxGaps - 1))] : Gap{};
+
+            if (gapPending && gap.at == r) {
+                // the audio thread dropped blocks here: silence of their length keeps the timing
+                planar_.clear();
+                for (int64_t left = gap.frames; left > 0;) {
+                    const int n = (int)juce::jmin(left, (int64_t)slice, partFrames_ - framesInPart_);
+                    writeSlice(n, true);
+                    left -= n;
+                }
+                gapRead_.store(g + 1, std::memory_order_release);
+                continue;
+            }
+            if (w == r) return;
+
+            // up to a slice, not past the next gap, and not across a part boundary
+            const int64_t available = gapPending ? juce::jmin(w, gap.at) - r : w - r;
+            const int n = (int)juce::jmin(available, (int64_t)slice, partFrames_ - framesInPart_);
+            for (int ch = 0; ch < numCh; ++ch) {
+                float* dst = planar_.getWritePointer(ch);
+                for (int i = 0; i < n; ++i)
+                    dst[i] = ring_[(size_t)(((r + i) & (kRingFrames - 1)) * numCh + ch)];
+            }
+            read_.store(r + n, std::memory_order_release);
+            writeSlice(n, false);
+        }
+    }
+
+    void SetRecorder::writeSlice(int n, bool silence)
+    {
+        // a part that failed to open: the audio is consumed and lost, counted as dropped
+        if (writer_ == nullptr || !writer_->writeFromAudioSampleBuffer(planar_, 0, n)) {
+            writeError_.store(true);
+            if (!silence)
+                dropped_.fetch_add((size_t)n, std::memory_order_relaxed);
+        }
+        else {
+            written_.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        framesInPart_ += n;
+        if (framesInPart_ >= partFrames_) {
+            // a new part starts counting even if it fails to open, so the slices keep moving
+            framesInPart_ = 0;
+            openPart(part_.load(std::memory_order_relaxed) + 1);
+        }
+    }
+
+} // namespace ttvst
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    SetRecorder.h
+    Records the plugin's main output to WAV/FLAC from a background thread,
+    starting a new file every so often.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ttvst {
+
+    /**
+     * While armed, push() from the audio thread copies the block into a lock-free ring
+     * of interleaved float frames; a background thread encodes the ring to disk. A block
+     * that does not fit is dropped whole and counted (getDroppedSamples), never waited for:
+     * a slow disk costs a gap in the file, not a glitch on air. The gap is written as
+     * silence of the dropped length once the writer catches up, so everything after it
+     * keeps its place in the set.
+     *
+     * The set is split into parts of rotateMinutes each, "<name> part N.wav|flac",
+     * so one stalled or damaged file loses one part, and WAV stays far from its 4 GiB limit.
+     */
+    class SetRecorder : private juce::Thread
+    {
+    public:
+        enum class Format { wav = 0, flac };
+
+        static constexpr int kMaxChannels = 8;
+        static constexpr int kRingFrames = 1 << 18;   // ~5.5 s at 48 kHz before a block is dropped
+        static constexpr int kBitsPerSample = 24;
+        static constexpr int kMaxGaps = 64;           // overruns the writer has not reached yet
+
+        SetRecorder() : juce::Thread("ttvst set recorder") {}
+        ~SetRecorder() override { stop(); }
+
+        // Message thread. Parts go to folder as "<baseName> part N"; false if the first one
+        // cannot be created.
+        bool start(const juce::File& folder, const juce::String& baseName, Format format,
+            double sampleRate, int numChannels, double rotateMinutes = 60.0);
+
+        // Message thread. Writes out what the audio thread pushed so far and closes the file.
+        void stop();
+
+        bool isRecording() const noexcept { return armed_.load(std::memory_order_relaxed); }
+
+        // Audio thread. The first getNumChannels() channels of buffer.
+        template <typename FloatType>
+        void push(const juce::AudioBuffer<FloatType>& buffer) noexcept
+        {
+            // stop() waits for inPush_ to clear after disarming, so start() never changes the
+            // channel count under a push that saw the previous session armed
+            inPush_.store(true, std::memory_order_seq_cst);
+            if (armed_.load(std::memory_order_seq_cst))
+                pushArmed(buffer);
+            inPush_.store(false, std::memory_order_release);
+        }
+
+        // Any thread
+        int getNumChannels() const noexcept { return numChannels_; }
+        int64_t getRecordedSamples() const noexcept { return written_.load(std::memory_order_relaxed); }
+        size_t getDroppedSamples() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+        int getPartNumber() const noexcept { return part_.load(std::memory_order_relaxed); }
+        bool hasWriteError() const noexcept { return writeError_.load(std::memory_order_relaxed); }
+
+    private:
+        // Silence owed before ring frame `at`
+        struct Gap
+        {
+            int64_t at = 0;
+            int64_t frames = 0;
+        };
+
+        template <typename FloatType>
+        void pushArmed(const juce::AudioBuffer<FloatType>& buffer) noexcept
+        {
+            const int n = buffer.getNumSamples();
+            const int numCh = numChannels_;
+            if (n <= 0 || buffer.getNumChannels() == 0) return;
+            const int64_t w = write_.load(std::memory_order_relaxed);
+            auto drop = [&] {
+                dropped_.fetch_add((size_t)n, std::memory_order_relaxed);
+                gapFrames_ += n;
+            };
+            if (w + n - read_.load(std::memory_order_acquire) > kRingFrames) {
+                drop();
+                return;
+            }
+            if (gapFrames_ > 0) {
+                // the block goes in after the silence it has to follow; no room to say so, no block
+                const int64_t g = gapWrite_.load(std::memory_order_relaxed);
+                if (g - gapRead_.load(std::memory_order_acquire) >= kMaxGaps) {
+                    drop();
+                    return;
+                }
+                gaps_[(size_t)(g & (kMaxGaps - 1))] = { w, gapFrames_ };
+                gapWrite_.store(g + 1, std::memory_order_release);
+                gapFrames_ = 0;
+            }
+
+            for (int ch = 0; ch < numCh; ++ch) {
+                const FloatType* src = buffer.getReadPointer(juce::jmin(ch, buffer.getNumChannels() - 1));
+                for (int i = 0; i < n; ++i)
+                    ring_[(size_t)(((w + i) & (kRingFrames - 1)) * numCh + ch)] = (float)src[i];
+            }
+            write_.store(w + n, std::memory_order_release);
+        }
+
+        void run() override;
+        void drain(bool onWriterThread);   // writer thread, or stop() once it has exited
+        void writeSlice(int n, bool silence);   // planar_[0, n) to the current part
+        bool openPart(int number);      // closes the current part first
+
+        std::vector<float> ring_;       // kRingFrames x kMaxChannels, allocated by the first start()
+        std::atomic<int64_t> write_{ 0 };   // running frame counts, masked on access
+        std::atomic<int64_t> read_{ 0 };
+        std::atomic<bool> armed_{ false };
+        std::atomic<bool> inPush_{ false };
+        int numChannels_ = 2;           // set before arming, while no push() is running
+
+        std::array<Gap, kMaxGaps> gaps_{};
+        std::atomic<int64_t> gapWrite_{ 0 };   // running counts like write_/read_
+        std::atomic<int64_t> gapRead_{ 0 };
+        int64_t gapFrames_ = 0;         // audio thread: dropped since the last block that fit
+
+        std::atomic<int64_t> written_{ 0 };
+        std::atomic<size_t> dropped_{ 0 };
+        std::atomic<int> part_{ 0 };
+        std::atomic<bool> writeError_{ false };
+
+        // writer thread
+        std::unique_ptr<juce::AudioFormat> format_;
+        std::unique_ptr<juce::AudioFormatWriter> writer_;
+        juce::AudioBuffer<float> planar_;   // one drain slice, deinterleaved for the writer
+        juce::File folder_;
+        juce::String baseName_;
+        double sampleRate_ = 0.0;
+        int64_t partFrames_ = 0;        // frames per part
+        int64_t framesInPart_ = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(SetRecorder)
+    };
+
+} // namespace ttvst
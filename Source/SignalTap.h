@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    SignalTap.h
+    Records internal signal streams to a binary file from a background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ttvst::tap {
+
+    /*
+     * File layout (little-endian, every record 8-byte aligned so the file can be
+     * memory-mapped and walked in place; Scripts/read_tap.py does that):
+     *
+     *   FileHeader
+     *   StreamInfo[numStreams]
+     *   { ChunkHeader, double[count * width] } until end of file
+     *
+     * A chunk holds count items of one stream starting at sample time `time`. Per-sample
+     * streams have item i at time + i; event streams (knots) carry their own times.
+     */
+    struct FileHeader
+    {
+        char     magic[8] = { 'T', 'T', 'V', 'S', 'T', 'A', 'P', 0 };
+        uint32_t version = 1;
+        uint32_t numStreams = 0;
+        double   sampleRate = 0.0;
+        uint64_t reserved = 0;
+    };
+
+    struct StreamInfo
+    {
+        char     name[40] = {};
+        uint32_t id = 0;
+        uint32_t width = 1;     // doubles per item
+    };
+
+    struct ChunkHeader
+    {
+        static constexpr uint32_t kMagic = 0x4b4e4843;   // "CHNK"
+
+        uint32_t magic = kMagic;
+        uint32_t stream = 0;
+        int64_t  time = 0;
+        uint32_t count = 0;
+        uint32_t reserved = 0;
+    };
+
+    static_assert(sizeof(FileHeader) == 32 && sizeof(StreamInfo) == 48 && sizeof(ChunkHeader) == 24,
+        "tap records are read back by offset");
+
+    /**
+     * Streams are registered up front; while recording, write() from the audio thread
+     * is one memcpy of a ready-made chunk into a lock-free byte ring. A background
+     * thread copies the ring to the file. A chunk that does not fit is dropped whole
+     * and counted (getOverruns), never waited for.
+     */
+    class SignalTapRecorder : private juce::Thread
+    {
+    public:
+        static constexpr size_t capacity = (size_t)1 << 22;   // ring bytes, power-of-two
+        static constexpr int kMaxStreams = 16;
+
+        SignalTapRecorder() : juce::Thread("ttvst signal tap") {}
+
+        ~SignalTapRecorder() override { stop(); }
+
+        // Message thread, before start(). Returns the stream id for write().
+        int addStream(const char* name, int width)
+        {
+            jassert(!isRecording() && (int)streams_.size() < kMaxStreams);
+            StreamInfo s;
+            std::strncpy(s.name, name, sizeof(s.name) - 1);
+            s.id = (uint32_t)streams_.size();
+            s.width = (uint32_t)juce::jmax(1, width);
+            streams_.push_back(s);
+            return (int)s.id;
+        }
+
+        // Message thread. Streams not in streamMask are skipped by write().
+        bool start(const juce::File& file, double sampleRate, uint32_t streamMask = ~0u)
+        {
+            stop();
+
+            if (ring_.empty()) ring_.assign(capacity, 0);
+
+            file.deleteFile();
+            auto out = std::make_unique<juce::FileOutputStream>(file);
+            if (!out->openedOk()) return false;
+
+            FileHeader h;
+            h.numStreams = (uint32_t)streams_.size();
+            h.sampleRate = sampleRate;
+            out->write(&h, sizeof(h));
+            out->write(streams_.data(), streams_.size() * sizeof(StreamInfo));
+            out_ = std::move(out);
+
+            // anything left from an earlier run belongs to the old file
+            read_.store(write_.load(std::memory_order_acquire), std::memory_order_release);
+            overruns_.store(0);
+            mask_.store(streamMask, std::memory_order_release);
+            startThread(juce::Thread::Priority::low);
+            return true;
+        }
+
+        // Message thread. Flushes what the audio thread has written so far.
+        void stop()
+        {
+            if (mask_.exchange(0, std::memory_order_acq_rel) == 0 && out_ == nullptr) return;
+            stopThread(2000);
+            drain();
+            out_.reset();
+        }
+
+        bool isRecording() const noexcept { return mask_.load(std::memory_order_relaxed) != 0; }
+
+        // Audio thread: worth preparing data for this stream?
+        bool isOn(int stream) const noexcept
+        {
+            return (mask_.load(std::memory_order_relaxed) >> stream) & 1u;
+        }
+
+        // Audio thread. count items of the stream's width, starting at sample time `time`.
+        void write(int stream, int64_t time, const double* data, int count) noexcept
+        {
+            if (!isOn(stream) || count <= 0) return;
+
+            ChunkHeader h;
+            h.stream = (uint32_t)stream;
+            h.time = time;
+            h.count = (uint32_t)count;
+            const size_t payload = (size_t)count * streams_[(size_t)stream].width * sizeof(double);
+
+            const size_t w = write_.load(std::memory_order_relaxed);
+            if (w + sizeof(h) + payload - read_.load(std::memory_order_acquire) > capacity) {
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            copyIn(w, &h, sizeof(h));
+            copyIn(w + sizeof(h), data, payload);
+            write_.store(w + sizeof(h) + payload, std::memory_order_release);
+        }
+
+        size_t getOverruns() const noexcept { return overruns_.load(std::memory_order_relaxed); }
+
+    private:
+        void run() override
+        {
+            while (!threadShouldExit()) {
+                drain();
+                wait(20);
+            }
+        }
+
+        // Writer thread (or stop() once it has exited)
+        void drain()
+        {
+            if (out_ == nullptr) return;
+            const size_t r = read_.load(std::memory_order_relaxed);
+            const size_t w = write_.load(std::memory_order_acquire);
+            if (w == r) return;
+
+            const size_t from = r & (capacity - 1);
+            const size_t first = juce::jmin(w - r, capacity - from);
+            out_->write(ring_.data() + from, first);
+            if (first < w - r)
+                out_->write(ring_.data(), w - r - first);
+            read_.store(w, std::memory_order_release);
+        }
+
+        void copyIn(size_t at, const void* src, size_t n) noexcept
+        {
+            const size_t from = at & (capacity - 1);
+            const size_t first = juce::jmin(n, capacity - from);
+            std::memcpy(ring_.data() + from, src, first);
+            std::memcpy(ring_.data(), static_cast<const char*>(src) + first, n - first);
+        }
+
+        std::vector<StreamInfo> streams_;
+        std::vector<char> ring_;            // allocated by the first start()
+        std::atomic<size_t> write_{ 0 };    // running byte counts, masked on access
+        std::atomic<size_t> read_{ 0 };
+        std::atomic<uint32_t> mask_{ 0 };
+        std::atomic<size_t> overruns_{ 0 };
+        std::unique_ptr<juce::FileOutputStream> out_;
+
+        JUCE_DECLARE_NON_COPYABLE(SignalTapRecorder)
+    };
+
+} // namespace ttvst::tap
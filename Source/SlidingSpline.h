@@ -0,0 +1,291 @@
+/*
+  ==============================================================================
+
+    SlidingSpline.h
+    Cubic spline over a moving window of pitch-wheel knots.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+namespace ttvst::splines {
+
+    /**
+     * Platter position as a cubic spline through knots at absolute sample times, built
+     * up as knots arrive instead of re-solved from scratch every block.
+     *
+     * Segments the render has entered are frozen. The rest (the lookahead tail) is a
+     * spline clamped to the slope of the last frozen segment and natural at the newest
+     * knot. The forward sweep of that tridiagonal system is kept per knot, so a new knot
+     * costs one elimination step; back substitution only runs over the tail, capped at
+     * kMaxTail knots (a knot further out moves the frozen end by < 0.27^16). Position and
+     * slope are continuous across blocks, whatever the block size.
+     *
+     * prepare() allocates; addKnot() and render() never do.
+     */
+    class SlidingSpline
+    {
+    public:
+        static constexpr int kMaxTail = 16;
+
+        void prepare(int maxKnots)
+        {
+            knots_.assign((size_t)std::max(maxKnots, 4), Knot{});
+            reset();
+        }
+
+        void reset() noexcept
+        {
+            first_ = end_ = seg_ = frozen_ = 0;
+            slope_ = 0.0;
+            dirty_ = false;
+            renderTime_ = std::numeric_limits<int64_t>::min();
+        }
+
+        bool isEmpty() const noexcept { return end_ == first_; }
+
+        // Position at the last rendered sample
+        double getPosition() const noexcept { return pos_; }
+
+        /**
+         * Straight lines between knots instead of the spline, for when there is no CPU
+         * to spare: no elimination per knot, no back substitution. Applies from the next
+         * segment the render enters, where both shapes pass through the same knot, so
+         * the position stays continuous (the slope steps there).
+         */
+        void setLinear(bool shouldBeLinear) noexcept
+        {
+            linear_ = shouldBeLinear;
+            if (linear_) resweep_ = true;   // rows added meanwhile are not eliminated
+        }
+        bool isLinear() const noexcept { return linear_; }
+
+        /**
+         * Knots must come in time order. A knot at the time of the newest one replaces it.
+         * A knot after a gap the render has already run into (the wheel was let go)
+         * starts a new curve from rest, without a jump in the rendered position.
+         * Returns false if the window was full of knots the render has not reached: the
+         * curve then starts over from the last rendered position, the knot after it, so
+         * the platter keeps following the wheel (the slope steps there).
+         */
+        bool addKnot(int64_t t, double y) noexcept
+        {
+            if (!isEmpty()) {
+                Knot& last = knots_[(size_t)(end_ - 1)];
+                if (t < last.t) return true;    // out of order, keep the older curve
+                if (t == last.t) {
+                    if (end_ - 1 <= frozen_) return true;   // already being played
+                    --end_;
+                }
+                else if (renderTime_ > last.t) {
+                    restart(t, y);
+                    return true;
+                }
+            }
+            else {
+                restart(t, y);
+                return true;
+            }
+
+            bool fits = true;
+            if (end_ == (int)knots_.size() && !compact()) {
+                fits = false;
+                if (renderTime_ == std::numeric_limits<int64_t>::min() || renderTime_ - 1 >= t) {
+                    restart(t, y);
+                    return false;
+                }
+                restart(renderTime_ - 1, pos_);
+            }
+
+            knots_[(size_t)end_] = { t, y };
+            ++end_;
+            if (end_ <= systemEnd()) {
+                if (!resweep_) eliminate(end_ - 2);
+                dirty_ = true;
+            }
+            return fits;
+        }
+
+        /**
+         * Per-sample position differences for times [t0, t0 + n) into out (the playback
+         * ratio). Outside the knots the position holds. Returns false, leaving out alone,
+         * when no sample of the range lies on the curve.
+         */
+        bool render(int64_t t0, int n, double* out) noexcept
+        {
+            if (isEmpty() || n <= 0) {
+                renderTime_ = t0 + n;
+                return false;
+            }
+
+            const int64_t tFirst = knots_[(size_t)first_].t;
+            const int64_t tLast = knots_[(size_t)(end_ - 1)].t;
+            const bool onCurve = t0 + n > tFirst && t0 <= tLast;
+            renderTime_ = t0 + n;
+            if (!onCurve) {
+                if (t0 > tLast) pos_ = knots_[(size_t)(end_ - 1)].y;
+                return false;
+            }
+
+            int i = 0;
+            while (i < n) {
+                const int64_t t = t0 + i;
+                while (seg_ + 1 < end_ && t >= knots_[(size_t)(seg_ + 1)].t)
+                    ++seg_;
+
+                const Knot& k = knots_[(size_t)seg_];
+                if (t < k.t || seg_ == end_ - 1) {
+                    // before the first knot or past the last: hold
+                    const int64_t stop = t < k.t ? std::min<int64_t>(k.t, t0 + n) : t0 + n;
+                    for (; t0 + i < stop; ++i) {
+                        out[i] = k.y - pos_;
+                        pos_ = k.y;
+                    }
+                    continue;
+                }
+
+                if (seg_ >= frozen_)
+                    freezeThrough(seg_);
+
+                const Knot& s = knots_[(size_t)seg_];
+                const int64_t stop = std::min<int64_t>(knots_[(size_t)(seg_ + 1)].t, t0 + n);
+                for (; t0 + i < stop; ++i) {
+                    const double x = (double)(t0 + i - s.t);
+                    const double p = s.y + x * (s.b + x * (s.c + x * s.d));
+                    out[i] = p - pos_;
+                    pos_ = p;
+                }
+            }
+
+            // frozen segments behind the render are never read again
+            first_ = seg_;
+            return true;
+        }
+
+    private:
+        struct Knot
+        {
+            int64_t t = 0;
+            double  y = 0.0;
+            double  b = 0.0, c = 0.0, d = 0.0;   // segment to the next knot, once solved
+            double  l = 0.0, mu = 0.0, z = 0.0;  // forward sweep of the tail system
+        };
+
+        void restart(int64_t t, double y) noexcept
+        {
+            first_ = seg_ = frozen_ = 0;
+            end_ = 1;
+            knots_[0] = { t, y };
+            slope_ = 0.0;       // a platter picked up from rest
+            pos_ = y;           // held until t, no step in the output
+            dirty_ = false;
+            resweep_ = linear_;
+        }
+
+        // One past the last knot of the tail system
+        int systemEnd() const noexcept { return std::min(end_, frozen_ + kMaxTail + 1); }
+
+        // Row j of the tail system (j in [frozen_, systemEnd() - 1)), which needs knot j + 1
+        void eliminate(int j) noexcept
+        {
+            if (j < frozen_) return;
+            Knot& k = knots_[(size_t)j];
+            const Knot& next = knots_[(size_t)(j + 1)];
+            const double h1 = (double)(next.t - k.t);
+
+            if (j == frozen_) {
+                // clamped to the slope the frozen curve arrives with
+                k.l = 2.0 * h1;
+                k.mu = 0.5;
+                k.z = (3.0 * (next.y - k.y) / h1 - 3.0 * slope_) / k.l;
+                return;
+            }
+
+            const Knot& prev = knots_[(size_t)(j - 1)];
+            const double h0 = (double)(k.t - prev.t);
+            const double alpha = 3.0 * (next.y - k.y) / h1 - 3.0 * (k.y - prev.y) / h0;
+            k.l = 2.0 * (h0 + h1) - h0 * prev.mu;
+            k.mu = h1 / k.l;
+            k.z = (alpha - h0 * prev.z) / k.l;
+        }
+
+        // Back substitution over the tail, natural end at its last knot
+        void solve() noexcept
+        {
+            double cNext = 0.0;
+            for (int j = systemEnd() - 2; j >= frozen_; --j) {
+                Knot& k = knots_[(size_t)j];
+                const Knot& next = knots_[(size_t)(j + 1)];
+                const double h = (double)(next.t - k.t);
+                k.c = k.z - k.mu * cNext;
+                k.b = (next.y - k.y) / h - h * (cNext + 2.0 * k.c) / 3.0;
+                k.d = (cNext - k.c) / (3.0 * h);
+                cNext = k.c;
+            }
+            dirty_ = false;
+        }
+
+        // Fix segments up to j one at a time, re-clamping the tail after each
+        void freezeThrough(int j) noexcept
+        {
+            while (frozen_ <= j) {
+                if (linear_) {
+                    Knot& k = knots_[(size_t)frozen_];
+                    const Knot& next = knots_[(size_t)(frozen_ + 1)];
+                    k.b = slope_ = (next.y - k.y) / (double)(next.t - k.t);
+                    k.c = k.d = 0.0;
+                    ++frozen_;
+                    continue;
+                }
+                if (resweep_) {
+                    // back from linear: the tail rows start again from the slope we arrive with
+                    const int last = systemEnd() - 1;
+                    for (int r = frozen_; r < last; ++r)
+                        eliminate(r);
+                    resweep_ = false;
+                    dirty_ = frozen_ < last;
+                }
+                if (dirty_) solve();
+
+                const Knot& k = knots_[(size_t)frozen_];
+                const double h = (double)(knots_[(size_t)(frozen_ + 1)].t - k.t);
+                slope_ = k.b + h * (2.0 * k.c + 3.0 * h * k.d);
+                ++frozen_;
+
+                const int last = systemEnd() - 1;
+                for (int r = frozen_; r < last; ++r)
+                    eliminate(r);
+                dirty_ = frozen_ < last;
+            }
+        }
+
+        // Drop the played-out knots in front of the window
+        bool compact() noexcept
+        {
+            if (first_ == 0) return false;
+            std::move(knots_.begin() + first_, knots_.begin() + end_, knots_.begin());
+            end_ -= first_;
+            seg_ -= first_;
+            frozen_ -= first_;
+            first_ = 0;
+            return true;
+        }
+
+        std::vector<Knot> knots_;
+        int first_ = 0, end_ = 0;   // live knots [first_, end_)
+        int seg_ = 0;               // segment the render is in
+        int frozen_ = 0;            // segments before this knot are fixed
+        double slope_ = 0.0;        // dp/dt arriving at knots_[frozen_]
+        double pos_ = 0.0;          // last rendered position
+        bool dirty_ = false;        // tail needs back substitution
+        bool linear_ = false;       // see setLinear
+        bool resweep_ = false;      // tail rows are stale, eliminate them all before solving
+        int64_t renderTime_ = 0;    // first sample not yet rendered
+    };
+
+} // namespace ttvst::splines
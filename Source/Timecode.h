@@ -0,0 +1,360 @@
+/*
+  ==============================================================================
+
+    Timecode.h
+    Control-signal (digital vinyl) decoder and a matching signal generator.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ttvst::timecode {
+
+    /**
+     * The control record: a stereo sine carrier in quadrature (left = cos, right = sin,
+     * so the phase advances when the platter turns forward). Every carrier cycle carries
+     * one bit of a maximal-length LFSR sequence as its amplitude (1.0 or lowLevel), so any
+     * `bits` consecutive cycles identify the absolute cycle number.
+     * 1 kHz and 20 bits give 2^20 - 1 cycles, 17.5 minutes per side.
+     */
+    struct Format
+    {
+        double   carrierHz = 1000.0;
+        int      bits = 20;
+        uint32_t taps = 0x9;           // x^20 + x^17 + 1, right-shifting Fibonacci form
+        uint32_t seed = 0x1;
+        float    lowLevel = 0.5f;      // amplitude of a 0 bit, 1 bits are at 1.0
+
+        uint32_t mask() const noexcept { return (1u << bits) - 1u; }
+        uint32_t length() const noexcept { return mask(); }   // cycles before the sequence repeats
+
+        // State k holds bits k .. k + bits - 1 of the sequence, bit k in the LSB
+        uint32_t next(uint32_t s) const noexcept
+        {
+            uint32_t fb = s & taps;
+            fb ^= fb >> 16; fb ^= fb >> 8; fb ^= fb >> 4; fb ^= fb >> 2; fb ^= fb >> 1;
+            return (s >> 1) | ((fb & 1u) << (bits - 1));
+        }
+
+        uint32_t previous(uint32_t s) const noexcept
+        {
+            // the bit shifted out is whatever makes the feedback of the old state match the new MSB
+            const uint32_t shifted = (s << 1) & mask();
+            const uint32_t msb = (s >> (bits - 1)) & 1u;
+            uint32_t fb = shifted & taps;
+            fb ^= fb >> 16; fb ^= fb >> 8; fb ^= fb >> 4; fb ^= fb >> 2; fb ^= fb >> 1;
+            return shifted | ((fb ^ msb) & 1u);
+        }
+    };
+
+    //==============================================================================
+    /**
+     * Synthetic control signal, as a turntable would play it at a given speed.
+     * For tests and calibration: render() follows any speed curve, backwards included.
+     */
+    class Generator
+    {
+    public:
+        void prepare(double sampleRate, const Format& f = {})
+        {
+            format_ = f;
+            sampleRate_ = sampleRate;
+            setPosition(0.0);
+        }
+
+        // Position in carrier cycles from the start of the sequence
+        void setPosition(double cycles)
+        {
+            phase_ = cycles;
+            cycle_ = (int64_t)std::floor(cycles);
+            state_ = format_.seed;
+            for (int64_t k = 0; k < cycle_; ++k) state_ = format_.next(state_);
+        }
+
+        double getPosition() const noexcept { return phase_; }
+
+        // speed: 1.0 = nominal (carrierHz cycles per second), negative = backwards
+        void render(float* left, float* right, int numSamples, double speed) noexcept
+        {
+            constexpr double twoPi = 6.283185307179586;
+            const double inc = speed * format_.carrierHz / sampleRate_;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto c = (int64_t)std::floor(phase_);
+                for (; cycle_ < c; ++cycle_) state_ = format_.next(state_);
+                for (; cycle_ > c; --cycle_) state_ = format_.previous(state_);
+
+                const float amp = (state_ & 1u) ? 1.0f : format_.lowLevel;
+                const double theta = twoPi * (phase_ - (double)c);
+                left[i] = amp * (float)std::cos(theta);
+                right[i] = amp * (float)std::sin(theta);
+                phase_ += inc;
+            }
+        }
+
+    private:
+        Format format_;
+        double sampleRate_ = 44100.0;
+        double phase_ = 0.0;
+        int64_t cycle_ = 0;
+        uint32_t state_ = 1;
+    };
+
+    //==============================================================================
+    /**
+     * Real-time decoder: stereo control signal in, platter movement out.
+     *
+     * - Relative motion: the quadrature angle of every sample, computed for the whole block
+     *   in branch-free loops (polynomial atan2) the compiler vectorizes, and unwrapped.
+     *   That gives the platter position to a small fraction of a cycle, sample by sample.
+     * - Absolute position: every finished cycle contributes its amplitude bit; once `bits`
+     *   bits in one direction are in, the LFSR state is looked up in a table built by
+     *   prepare(). kLockCycles agreeing lookups in a row lock the absolute offset.
+     *
+     * prepare() allocates (the lookup table is 4 MB for 20 bits); process() does not.
+     */
+    class Decoder
+    {
+    public:
+        static constexpr int kLockCycles = 8;        // agreeing lookups before the offset is trusted
+        static constexpr int kUnlockErrors = 16;     // disagreeing ones before it is dropped
+
+        struct Status
+        {
+            bool   signal = false;      // carrier present
+            bool   locked = false;      // absolute position known
+            double position = 0.0;      // carrier cycles at the block's first sample (absolute when locked)
+            double speed = 0.0;         // smoothed, 1.0 = nominal, negative = backwards
+        };
+
+        void prepare(double sampleRate, int maxBlockSize, const Format& f = {})
+        {
+            const bool rebuild = f.bits != format_.bits || f.taps != format_.taps || f.seed != format_.seed || lookup_.empty();
+            format_ = f;
+            sampleRate_ = sampleRate;
+            delta_.assign((size_t)std::max(1, maxBlockSize), 0.0f);
+            angle_.assign(delta_.size(), 0.0f);
+
+            if (rebuild)
+            {
+                lookup_.assign((size_t)format_.mask() + 1, -1);
+                uint32_t s = format_.seed;
+                for (uint32_t k = 0; k < format_.length(); ++k)
+                {
+                    lookup_[s] = (int32_t)k;
+                    s = format_.next(s);
+                }
+            }
+            reset();
+        }
+
+        void reset() noexcept
+        {
+            prevAngle_ = 0.0f;
+            acquired_ = false;
+            dcL_ = dcR_ = 0.0f;
+            level_ = 0.0f;
+            position_ = 0.0;
+            cycle_ = 0;
+            offset_ = 0;
+            locked_ = false;
+            agree_ = errors_ = 0;
+            reg_ = 0;
+            regBits_ = 0;
+            lastDir_ = 0;
+            cyclePower_ = 0.0f;
+            cycleCount_ = 0;
+            meanLevel_ = 0.75f;
+            speed_ = 0.0;
+        }
+
+        /**
+         * Decodes one block. cyclesOut (numSamples) receives the platter movement per
+         * sample in carrier cycles; zero while there is no carrier.
+         */
+        Status process(const float* left, const float* right, int numSamples, double* cyclesOut) noexcept
+        {
+            Status st;
+            const double startRelative = position_;
+            st.position = position_ + (locked_ ? (double)offset_ : 0.0);
+            numSamples = std::min(numSamples, (int)delta_.size());
+            if (numSamples <= 0) return st;
+
+            // DC estimate follows the block means (phono stages leak a little), but only
+            // of blocks without carrier or spanning whole cycles: the mean of a carrier
+            // standing still, or of part of a cycle, is wherever the platter is
+            float sumL = 0.0f, sumR = 0.0f, sumMag = 0.0f;
+            for (int i = 0; i < numSamples; ++i) { sumL += left[i]; sumR += right[i]; }
+            const auto trackDc = [&]() noexcept {
+                dcL_ += (sumL / (float)numSamples - dcL_) * 0.1f;
+                dcR_ += (sumR / (float)numSamples - dcR_) * 0.1f;
+            };
+
+            // Pass 1, vectorizable: carrier angle of every sample as a fraction of a cycle,
+            // then the wrapped step from the previous one. The steps telescope, so the
+            // accumulated position keeps the exact carrier phase (no atan2 error build-up).
+            float* angle = angle_.data();
+            float* delta = delta_.data();
+            {
+                const float dl = dcL_, dr = dcR_;
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float l = left[i] - dl, r = right[i] - dr;
+                    angle[i] = fastAtan2(r, l) * kInvTwoPi;
+                    sumMag += l * l + r * r;
+                }
+                delta[0] = angle[0] - prevAngle_;
+                for (int i = 1; i < numSamples; ++i)
+                    delta[i] = angle[i] - angle[i - 1];
+                for (int i = 0; i < numSamples; ++i)
+                    delta[i] -= std::floor(delta[i] + 0.5f);     // into [-0.5, 0.5)
+                prevAngle_ = angle[numSamples - 1];
+            }
+
+            level_ += (std::sqrt(sumMag / (float)numSamples) - level_) * 0.2f;
+            st.signal = level_ > kSignalThreshold;
+            if (!st.signal)
+            {
+                std::fill(cyclesOut, cyclesOut + numSamples, 0.0);
+                speed_ = 0.0;
+                regBits_ = 0;
+                acquired_ = false;
+                trackDc();
+                st.locked = locked_;
+                return st;
+            }
+
+            if (!acquired_)
+            {
+                // (re)acquired: align the fractional position with the carrier phase, so
+                // cycle boundaries fall where the amplitude bits change
+                const double a0 = angle[0] < 0.0f ? angle[0] + 1.0 : angle[0];
+                position_ = std::floor(position_) + a0;
+                cycle_ = (int64_t)std::floor(position_);
+                delta[0] = 0.0f;
+                cyclePower_ = 0.0f;
+                cycleCount_ = 0;
+                acquired_ = true;
+            }
+
+            // Pass 2, scalar: integrate, read one bit per finished cycle
+            const float dl = dcL_, dr = dcR_;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double d = (double)delta[i];
+                cyclesOut[i] = d;
+                position_ += d;
+
+                const auto c = (int64_t)std::floor(position_);
+                if (c != cycle_)
+                {
+                    // forward finishes cycle_ (c = cycle_ + 1), backward finishes cycle_ too
+                    if (cycleCount_ > 0)
+                        readBit(cycle_, c > cycle_ ? 1 : -1, std::sqrt(cyclePower_ / (float)cycleCount_));
+                    cycle_ = c;
+                    cyclePower_ = 0.0f;
+                    cycleCount_ = 0;
+                }
+
+                // this sample belongs to cycle c: its level counts towards c's bit
+                const float l = left[i] - dl, r = right[i] - dr;
+                cyclePower_ += l * l + r * r;
+                ++cycleCount_;
+            }
+
+            if (std::abs(position_ - startRelative) >= 1.0)
+                trackDc();
+
+            const double blockSpeed = (position_ - startRelative) * sampleRate_ / ((double)numSamples * format_.carrierHz);
+            speed_ += (blockSpeed - speed_) * 0.3;
+
+            st.locked = locked_;
+            st.position = startRelative + (double)delta[0] + (locked_ ? (double)offset_ : 0.0);
+            st.speed = speed_;
+            return st;
+        }
+
+        const Format& getFormat() const noexcept { return format_; }
+
+    private:
+        static constexpr float kInvTwoPi = 0.15915494309189535f;
+        static constexpr float kSignalThreshold = 0.02f;
+
+        // |error| < 1e-5 rad; selects instead of branches so the loop stays vectorizable
+        static float fastAtan2(float y, float x) noexcept
+        {
+            constexpr float halfPi = 1.5707963267948966f, pi = 3.141592653589793f;
+            const float ax = std::fabs(x), ay = std::fabs(y);
+            const float mx = std::max(ax, ay), mn = std::min(ax, ay);
+            const float a = mn / (mx + 1.0e-30f);
+            const float s = a * a;
+            float r = ((((-0.0040540580f * s + 0.0218612288f) * s - 0.0559098861f) * s + 0.0964200441f) * s
+                       - 0.1390853351f) * s;
+            r = (((r + 0.1994653599f) * s - 0.3332985605f) * s) * a + a;
+            r = ay > ax ? halfPi - r : r;
+            r = x < 0.0f ? pi - r : r;
+            return y < 0.0f ? -r : r;
+        }
+
+        // level: RMS of the quadrature magnitude over the cycle (constant within one)
+        void readBit(int64_t finishedCycle, int dir, float level) noexcept
+        {
+            const uint32_t bit = level > meanLevel_ ? 1u : 0u;
+            meanLevel_ += (level - meanLevel_) * 0.05f;
+
+            if (dir != lastDir_) regBits_ = 0;   // the register only holds bits read in one direction
+            lastDir_ = dir;
+
+            // forward: reg = state of the oldest cycle held; backward: state of the newest
+            if (dir > 0) reg_ = (reg_ >> 1) | (bit << (format_.bits - 1));
+            else         reg_ = ((reg_ << 1) | bit) & format_.mask();
+            if (++regBits_ < format_.bits) return;
+            regBits_ = format_.bits;
+
+            const int32_t k = lookup_[reg_];
+            if (k < 0) { miss(); return; }
+
+            const int64_t absolute = dir > 0 ? (int64_t)k + format_.bits - 1 : (int64_t)k;
+            const int64_t offset = absolute - finishedCycle;
+            if (offset == offset_)
+            {
+                errors_ = 0;
+                if (++agree_ >= kLockCycles) locked_ = true;
+            }
+            else
+            {
+                miss();
+                if (!locked_) { offset_ = offset; agree_ = 1; }
+            }
+        }
+
+        void miss() noexcept
+        {
+            agree_ = 0;
+            if (locked_ && ++errors_ >= kUnlockErrors) { locked_ = false; errors_ = 0; }
+        }
+
+        Format format_;
+        double sampleRate_ = 44100.0;
+        std::vector<int32_t> lookup_;        // LFSR state -> cycle number, -1 for the all-zero state
+        std::vector<float> angle_, delta_;
+
+        float prevAngle_ = 0.0f, dcL_ = 0.0f, dcR_ = 0.0f, level_ = 0.0f;
+        double position_ = 0.0;              // relative, in cycles
+        int64_t cycle_ = 0;                  // floor(position_)
+        int64_t offset_ = 0;                 // absolute - relative cycle, valid when locked_
+        bool locked_ = false, acquired_ = false;
+        int agree_ = 0, errors_ = 0;
+        uint32_t reg_ = 0;
+        int regBits_ = 0, lastDir_ = 0;
+        float cyclePower_ = 0.0f, meanLevel_ = 0.75f;
+        int cycleCount_ = 0;
+        double speed_ = 0.0;
+    };
+
+} // namespace ttvst::timecode
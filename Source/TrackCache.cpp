@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    TrackCache.cpp
+
+  ==============================================================================
+*/
+
+#include "TrackCache.h"
+#include "MemoryResidency.h"
+
+namespace ttvst {
+
+    TrackCache::~TrackCache()
+    {
+        // decode jobs call back into the cache
+        cancelLoadJobsFor(loaderPool_->pool, this);
+
+        const juce::ScopedLock sl(lock_);
+        for (auto& [key, slot] : slots_)
+            setSlotLocked(slot, false);
+        slots_.clear();     // retires whatever nobody else holds
+        live_.clear();
+        inFlight_.clear();
+    }
+
+    juce::String TrackCache::makeKey(const juce::File& file, codec::SampleStorage storage)
+    {
+        return file.getFullPathName()
+            + "|" + juce::String(file.getSize())
+            + "|" + juce::String(file.getLastModificationTime().toMilliseconds())
+            + "|" + juce::String((int)storage);
+    }
+
+    std::optional<TrackCache::Entry> TrackCache::find(const juce::String& key)
+    {
+        const juce::ScopedLock sl(lock_);
+        return findLocked(key);
+    }
+
+    std::optional<TrackCache::Entry> TrackCache::findLocked(const juce::String& key)
+    {
+        auto it = slots_.find(key);
+        if (it != slots_.end()) {
+            it->second.lastUse = ++useCounter_;
+            return it->second.entry;
+        }
+
+        // Evicted from the cache but still playing somewhere: share it and cache it again
+        auto live = live_.find(key);
+        if (live != live_.end()) {
+            Entry e{ live->second.forward.lock(), live->second.reversed.lock(), live->second.contentHash };
+            if (e.forward && e.reversed) {
+                insertLocked(key, e);
+                return e;
+            }
+            live_.erase(live);
+        }
+        return std::nullopt;
+    }
+
+    bool TrackCache::contains(const juce::String& key) const
+    {
+        const juce::ScopedLock sl(lock_);
+        return slots_.count(key) > 0;
+    }
+
+    void TrackCache::insertLocked(const juce::String& key, Entry entry, bool decoding, int pins)
+    {
+        if (!entry.forward || !entry.reversed) return;
+
+        auto& slot = slots_[key];
+        used_ -= slot.bytes;
+        const bool relock = slot.locked;
+        setSlotLocked(slot, false);
+
+        slot.bytes = entry.forward->getMemoryBytes() + entry.reversed->getMemoryBytes();
+        slot.entry = std::move(entry);
+        slot.lastUse = ++useCounter_;
+        slot.decoding = decoding;
+        slot.pins += pins;   // before evicting: a track pinned on insert never evicts itself
+        used_ += slot.bytes;
+        setSlotLocked(slot, relock);
+
+        live_[key] = { slot.entry.forward, slot.entry.reversed, slot.entry.contentHash };
+
+        evictIfNeeded();
+    }
+
+    void TrackCache::request(const void* owner, const juce::File& file, codec::SampleStorage storage, Callback onReady,
+        int decodeFrom)
+    {
+        const auto key = makeKey(file, storage);
+        std::optional<Entry> hit;
+        {
+            const juce::ScopedLock sl(lock_);
+            hit = findLocked(key);
+            if (!hit) {
+                auto pending = inFlight_.find(key);
+                const bool joining = pending != inFlight_.end();
+                inFlight_[key].push_back({ owner, std::move(onReady) });
+                if (joining) {
+                    DBG("TrackCache: joining in-flight decode " << file.getFileName());
+                    return;
+                }
+            }
+        }
+
+        if (hit) {
+            prefault(*hit);
+            if (onReady) onReady(&*hit);
+            return;
+        }
+
+        auto onDone = [this, key](TrackLoadJob::Result&& r) { finishDecode(key, std::move(r)); };
+        auto* job = new TrackLoadJob(this, file, 0, 0, {}, storage, std::move(onDone));
+        job->publishEarly(decodeFrom, [this, key](bool ok) { finishProgressiveDecode(key, ok); });
+        loaderPool_->pool.addJob(job, true);
+    }
+
+    void TrackCache::finishDecode(const juce::String& key, TrackLoadJob::Result&& r)
+    {
+        std::optional<Entry> entry;
+        if (r.audio.first && r.audio.second)
+            entry = Entry{ reclaimer_.adopt(std::move(r.audio.first)), reclaimer_.adopt(std::move(r.audio.second)), r.contentHash };
+
+        std::vector<Waiter> waiters;
+        {
+            const juce::ScopedLock sl(lock_);
+            if (entry) insertLocked(key, *entry, !r.complete);
+            auto it = inFlight_.find(key);
+            if (it != inFlight_.end()) {
+                waiters = std::move(it->second);
+                inFlight_.erase(it);
+            }
+        }
+
+        // a progressive entry is faulted in by the loader writing it; a preload has nobody waiting
+        if (entry && r.complete && !waiters.empty())
+            prefault(*entry);
+
+        const juce::ScopedLock cl(callbackLock_);
+        for (auto& w : waiters)
+            if (w.onReady) w.onReady(entry ? &*entry : nullptr);
+    }
+
+    void TrackCache::finishProgressiveDecode(const juce::String& key, bool ok)
+    {
+        const juce::ScopedLock sl(lock_);
+        auto it = slots_.find(key);
+        if (it == slots_.end()) return;
+
+        it->second.decoding = false;
+        if (!ok) {
+            // stopped short: decks playing it keep what is there, nobody else gets it
+            DBG("TrackCache: dropping partly decoded " << key);
+            eraseLocked(it);
+            live_.erase(key);
+        }
+        evictIfNeeded();
+    }
+
+    void TrackCache::prefault(const Entry& e)
+    {
+        mem::prefault(*e.forward);
+        mem::prefault(*e.reversed);
+    }
+
+    void TrackCache::eraseLocked(std::map<juce::String, Slot>::iterator it)
+    {
+        used_ -= it->second.bytes;
+        setSlotLocked(it->second, false);
+        slots_.erase(it);
+    }
+
+    void TrackCache::cancelRequestsFor(const void* owner)
+    {
+        {
+            const juce::ScopedLock sl(lock_);
+            for (auto& [key, waiters] : inFlight_)
+                for (auto& w : waiters)
+                    if (w.owner == owner) w.onReady = nullptr;
+        }
+
+        // a finishDecode that already collected this owner's callback is running it now
+        const juce::ScopedLock cl(callbackLock_);
+    }
+
+    void TrackCache::pin(const juce::String& key)
+    {
+        const juce::ScopedLock sl(lock_);
+        auto it = slots_.find(key);
+        if (it == slots_.end()) {
+            // evicted inside its own insert (alone over the budget), before the deck got
+            // here to pin it: the deck holds it, so cache it again already pinned
+            auto live = live_.find(key);
+            if (live == live_.end()) return;
+            Entry e{ live->second.forward.lock(), live->second.reversed.lock(), live->second.contentHash };
+            if (!e.forward || !e.reversed) return;
+            insertLocked(key, std::move(e), false, 1);
+            it = slots_.find(key);
+            if (it != slots_.end() && lockPinned_)
+                setSlotLocked(it->second, true);
+            return;
+        }
+        if (it->second.pins++ == 0 && lockPinned_)
+            setSlotLocked(it->second, true);
+    }
+
+    void TrackCache::unpin(const juce::String& key)
+    {
+        const juce::ScopedLock sl(lock_);
+        auto it = slots_.find(key);
+        if (it != slots_.end() && it->second.pins > 0 && --it->second.pins == 0)
+            setSlotLocked(it->second, false);
+        evictIfNeeded();
+    }
+
+    void TrackCache::setLockPinned(bool shouldLock)
+    {
+        const juce::ScopedLock sl(lock_);
+        lockPinned_ = shouldLock;
+        for (auto& [key, slot] : slots_)
+            if (slot.pins > 0)
+                setSlotLocked(slot, shouldLock);
+    }
+
+    bool TrackCache::getLockPinned() const
+    {
+        const juce::ScopedLock sl(lock_);
+        return lockPinned_;
+    }
+
+    bool TrackCache::isLocked(const juce::String& key) const
+    {
+        const juce::ScopedLock sl(lock_);
+        auto it = slots_.find(key);
+        return it != slots_.end() && it->second.locked;
+    }
+
+    void TrackCache::setSlotLocked(Slot& slot, bool shouldLock)
+    {
+        if (slot.locked == shouldLock || !slot.entry.forward || !slot.entry.reversed) return;
+
+        if (shouldLock) {
+            // over the OS limit (RLIMIT_MEMLOCK, working-set size) the track just stays pageable
+            const bool ok = mem::lock(*slot.entry.forward) & mem::lock(*slot.entry.reversed);
+            if (!ok) {
+                DBG("TrackCache: could not lock " << (int)(slot.bytes >> 20) << " MiB in RAM");
+                mem::unlock(*slot.entry.forward);
+                mem::unlock(*slot.entry.reversed);
+                return;
+            }
+        }
+        else {
+            mem::unlock(*slot.entry.forward);
+            mem::unlock(*slot.entry.reversed);
+        }
+        slot.locked = shouldLock;
+    }
+
+    void TrackCache::setMemoryBudget(size_t bytes)
+    {
+        const juce::ScopedLock sl(lock_);
+        budget_ = bytes;
+        evictIfNeeded();
+    }
+
+    size_t TrackCache::getMemoryBudget() const
+    {
+        const juce::ScopedLock sl(lock_);
+        return budget_;
+    }
+
+    size_t TrackCache::getUsedBytes() const
+    {
+        const juce::ScopedLock sl(lock_);
+        return used_;
+    }
+
+    void TrackCache::evictIfNeeded()
+    {
+        while (used_ > budget_)
+        {
+            auto victim = slots_.end();
+            for (auto it = slots_.begin(); it != slots_.end(); ++it)
+                if (it->second.pins == 0 && !it->second.decoding && (victim == slots_.end() || it->second.lastUse < victim->second.lastUse))
+                    victim = it;
+
+            if (victim == slots_.end())
+                return; // everything left is on air or still decoding
+
+            DBG("TrackCache: evicting " << victim->first);
+            eraseLocked(victim);   // live_ keeps a weak ref while a deck still plays it
+        }
+    }
+
+    void TrackCache::preload(const juce::File& file, codec::SampleStorage storage)
+    {
+        request(nullptr, file, storage, {});
+    }
+
+} // namespace ttvst
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    TrackCache.h
+    Process-wide registry and cache of decoded tracks with a memory budget.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+#include "LoadedAudio.h"
+#include "TrackLoader.h"
+#include "TrackReclaimer.h"
+
+namespace ttvst {
+
+    /**
+     * Every decoded track in the process, shared by all plugin instances through
+     * juce::SharedResourcePointer<TrackCache>.
+     * - entries are keyed by file identity + storage mode (see makeKey)
+     * - a track in use anywhere is found again (weak registry), so two instances
+     *   loading the same file share one immutable buffer
+     * - concurrent requests for the same key join a single in-flight decode
+     * - least recently used entries are dropped from the cache once the memory budget
+     *   is exceeded; pinned entries (on air on some deck) are never dropped
+     * - tracks are handed over with every page faulted in, before and outside the
+     *   callback lock, so one deck's page-in never holds up another deck's load
+     * - float32 tracks are shared while they still decode; the entry is kept until the
+     *   loader is done writing into it, and dropped if the decode stops short
+     * - the last owner to let go hands the buffers to a background reclaimer
+     * Message/loader threads only, never call this from processBlock.
+     */
+    class TrackCache
+    {
+    public:
+        struct Entry
+        {
+            LoadedAudioPtr forward, reversed;
+            juce::String   contentHash;
+        };
+
+        // Called on a loader thread (or inline on a hit); nullptr when the decode failed
+        using Callback = std::function<void(const Entry*)>;
+
+        static constexpr size_t defaultBudgetBytes = (size_t)1 << 30;   // 1 GiB
+
+        TrackCache() = default;
+        ~TrackCache();
+
+        // path + size + modification time + storage: a re-saved file gets a new key
+        static juce::String makeKey(const juce::File& file, codec::SampleStorage storage);
+
+        // Touches the entry (most recently used) on a hit
+        std::optional<Entry> find(const juce::String& key);
+        bool contains(const juce::String& key) const;
+
+        /**
+         * Hands `onReady` the decoded track for (file, storage): inline if it is cached or
+         * in use elsewhere, otherwise once the one decode for that key finishes.
+         * Float32 tracks are handed over as soon as they are allocated and fill in while
+         * they play, starting around sample `decodeFrom` (see loadFileProgressively).
+         * `owner` tags the callback for cancelRequestsFor.
+         */
+        void request(const void* owner, const juce::File& file, codec::SampleStorage storage, Callback onReady,
+            int decodeFrom = 0);
+
+        // Drops the owner's pending callbacks and waits for any that are running
+        void cancelRequestsFor(const void* owner);
+
+        // Pin counts nest; an entry is evictable again when its count drops to zero.
+        // A track evicted before its first pin but still held by a deck is cached again, pinned.
+        void pin(const juce::String& key);
+        void unpin(const juce::String& key);
+
+        // When on, pinned entries also have their pages locked in RAM (mem::lock) for as
+        // long as they stay pinned. Applies to the entries pinned right now too.
+        void setLockPinned(bool shouldLock);
+        bool getLockPinned() const;
+        bool isLocked(const juce::String& key) const;
+
+        void setMemoryBudget(size_t bytes);
+        size_t getMemoryBudget() const;
+        size_t getUsedBytes() const;
+
+        // Background thread that frees released tracks, shared by every instance
+        TrackReclaimer& getReclaimer() noexcept { return reclaimer_; }
+
+        // Decode in the background into the cache without publishing anywhere.
+        // No-op if the track is already cached or being decoded.
+        void preload(const juce::File& file, codec::SampleStorage storage);
+
+    private:
+        struct Slot
+        {
+            Entry       entry;
+            size_t      bytes = 0;
+            juce::uint64 lastUse = 0;
+            int         pins = 0;
+            bool        locked = false;
+            bool        decoding = false;   // published early, the loader still writes into it: kept
+        };
+
+        struct Live
+        {
+            std::weak_ptr<const LoadedAudio> forward, reversed;
+            juce::String contentHash;
+        };
+
+        struct Waiter
+        {
+            const void* owner = nullptr;
+            Callback    onReady;
+        };
+
+        std::optional<Entry> findLocked(const juce::String& key);
+        void insertLocked(const juce::String& key, Entry entry, bool decoding = false, int pins = 0);
+        void finishDecode(const juce::String& key, TrackLoadJob::Result&& r);
+        void finishProgressiveDecode(const juce::String& key, bool ok);
+        void eraseLocked(std::map<juce::String, Slot>::iterator it);
+        void evictIfNeeded();   // lock_ held
+        static void setSlotLocked(Slot& slot, bool shouldLock);
+        static void prefault(const Entry& e);   // no lock held
+
+        // Declared first: destroyed last, after every buffer the cache holds was retired
+        TrackReclaimer reclaimer_;
+        juce::SharedResourcePointer<SharedLoaderPool> loaderPool_;
+
+        std::map<juce::String, Slot> slots_;
+        std::map<juce::String, Live> live_;
+        std::map<juce::String, std::vector<Waiter>> inFlight_;
+        size_t budget_ = defaultBudgetBytes;
+        size_t used_ = 0;
+        juce::uint64 useCounter_ = 0;
+        bool lockPinned_ = false;
+        juce::CriticalSection lock_;
+        juce::CriticalSection callbackLock_;   // held while waiters run, see cancelRequestsFor
+
+        JUCE_DECLARE_NON_COPYABLE(TrackCache)
+    };
+
+} // namespace ttvst
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    TrackHandle.h
+    Wait-free publication of a deck's track to the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "LoadedAudio.h"
+#include "TrackReclaimer.h"
+
+namespace ttvst {
+
+    // What a deck plays: the track and its reversed copy, always swapped together
+    struct DeckTrack
+    {
+        LoadedAudioPtr forward, reversed;
+        uint64_t generation = 0;    // per handle, bumped by every publish: a new load, never an address
+    };
+
+    /**
+     * One deck's current track, published by message/loader threads and read by the
+     * audio thread without locks or refcount traffic (std::atomic_load on shared_ptr
+     * goes through a global lock pool in libstdc++/MSVC).
+     *
+     * Epoch scheme with a single reader:
+     * - the reader announces the epoch it starts in, then loads the raw pointer
+     * - publish() swaps the pointer, bumps the epoch and keeps the old value alive
+     * - an old value is released once the reader has announced a later epoch or is idle
+     * Releases happen in publish() or on the reclaimer thread, never in processBlock.
+     */
+    class TrackHandle : private TrackReclaimer::Collectable
+    {
+    public:
+        explicit TrackHandle(TrackReclaimer& reclaimer) : reclaimer_(reclaimer)
+        {
+            reclaimer_.attach(this);
+        }
+
+        ~TrackHandle() override
+        {
+            reclaimer_.detach(this);
+        }
+
+        //==============================================================================
+        // Writer side (any non-audio thread)
+
+        void publish(LoadedAudioPtr forward, LoadedAudioPtr reversed)
+        {
+            std::lock_guard<std::mutex> lock(writerLock_);
+            std::shared_ptr<const DeckTrack> next;
+            if (forward && reversed)
+                next = std::make_shared<const DeckTrack>(DeckTrack{ std::move(forward), std::move(reversed), ++generation_ });
+
+            current_.exchange(next.get(), std::memory_order_seq_cst);
+            const auto retireEpoch = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+            if (owned_) retired_.push_back({ std::move(owned_), retireEpoch });
+            owned_ = std::move(next);
+            collectLocked();
+        }
+
+        // Strong reference for non-audio readers (state, UI)
+        std::shared_ptr<const DeckTrack> getShared() const
+        {
+            std::lock_guard<std::mutex> lock(writerLock_);
+            return owned_;
+        }
+
+        //==============================================================================
+        // Reader side (audio thread only): wait-free, three atomic operations
+
+        const DeckTrack* beginRead() noexcept
+        {
+            readerEpoch_.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            return current_.load(std::memory_order_seq_cst);
+        }
+
+        void endRead() noexcept
+        {
+            readerEpoch_.store(idle, std::memory_order_release);
+        }
+
+    private:
+        static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+
+        struct Retired
+        {
+            std::shared_ptr<const DeckTrack> track;
+            uint64_t epoch;
+        };
+
+        void collect() override
+        {
+            std::lock_guard<std::mutex> lock(writerLock_);
+            collectLocked();
+        }
+
+        void collectLocked()
+        {
+            if (retired_.empty()) return;
+
+            // idle compares greater than every epoch
+            const auto reader = readerEpoch_.load(std::memory_order_seq_cst);
+            retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                [reader](const Retired& r) { return reader >= r.epoch; }), retired_.end());
+        }
+
+        TrackReclaimer& reclaimer_;
+        std::atomic<const DeckTrack*> current_{ nullptr };
+        std::atomic<uint64_t> epoch_{ 1 };
+        std::atomic<uint64_t> readerEpoch_{ idle };
+
+        std::shared_ptr<const DeckTrack> owned_;   // keeps *current_ alive
+        uint64_t generation_ = 0;
+        std::vector<Retired> retired_;
+        mutable std::mutex writerLock_;
+
+        JUCE_DECLARE_NON_COPYABLE(TrackHandle)
+    };
+
+} // namespace ttvst
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    TrackLoader.cpp
+
+  ==============================================================================
+*/
+
+#include "TrackLoader.h"
+
+namespace ttvst {
+
+    namespace {
+
+        constexpr int kReadBlock = 16384;   // read in chunks, so very long files work too
+
+        std::unique_ptr<juce::AudioFormatReader> openReader(juce::AudioFormatManager& fm, const juce::File& file)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
+            if (!reader || reader->numChannels <= 0 || reader->lengthInSamples <= 0) return {};
+            return reader;
+        }
+
+        // Both directions sized (zeroed, with guard samples on both sides), nothing decoded yet
+        LoadedPair allocatePair(const juce::AudioFormatReader& reader, int decodeFrom)
+        {
+            // Uwaga: AudioBuffer rozmiar w int – rzutujemy swiadomie (typowo pliki < 2 31 probek)
+            const int numSamples = (int)reader.lengthInSamples;
+            const int from = juce::jlimit(0, numSamples - 1, (decodeFrom / kReadBlock - 1) * kReadBlock);
+
+            auto out = std::make_unique<LoadedAudio>();
+            auto outReversed = std::make_unique<LoadedAudio>();
+            for (auto* audio : { out.get(), outReversed.get() }) {
+                audio->sampleRate = reader.sampleRate;
+                audio->allocate((int)reader.numChannels, numSamples);
+                audio->framesPending.store(numSamples, std::memory_order_relaxed);
+            }
+            out->decodeStart = from;
+            outReversed->decodeStart = numSamples - from;
+            outReversed->decodeDownward = true;
+            return { std::move(out), std::move(outReversed) };
+        }
+
+        // [decodeStart, end) and then [0, decodeStart), each chunk mirrored into the reversed
+        // copy right away; framesPending counts down as they fill. Chunks are read into a
+        // scratch buffer first: readers convert in place, and a published track must only
+        // ever hold finished floats. False when aborted or the reader fails.
+        bool decodeInto(juce::AudioFormatReader& reader, LoadedAudio& out, LoadedAudio& outReversed,
+            const std::function<bool()>& shouldAbort)
+        {
+            const int n = out.getNumSamples();
+            const int from = out.decodeStart;
+            juce::AudioBuffer<float> chunk(out.getNumChannels(), kReadBlock);
+            for (int done = 0; done < n;) {
+                if (shouldAbort && shouldAbort())
+                    return false;
+
+                const int pos = (from + done) % n;
+                const int toRead = juce::jmin(kReadBlock, (pos >= from ? n : from) - pos);
+
+                // Czytamy bezposrednio do bufora docelowego, za wiodacymi probkami ochronnymi.
+                // Flagi true/true odnosza sis do L/R przy plikach stereo — przy mono/wiecej kanalow
+                // JUCE i tak wypelni dostepne kanaly; to najczestszy przypadek (1–2 ch).
+                if (!reader.read(&chunk, 0, toRead, pos, true, true))
+                    return false;   // decks keep what was read, the cache drops the track
+
+                for (int ch = 0; ch < out.getNumChannels(); ++ch) {
+                    const float* src = chunk.getReadPointer(ch);
+                    std::copy(src, src + toRead, out.getWritePointer(ch) + pos);
+                    std::reverse_copy(src, src + toRead, outReversed.getWritePointer(ch) + (n - pos - toRead));
+                }
+
+                done += toRead;
+                out.framesPending.store(n - done, std::memory_order_release);
+                outReversed.framesPending.store(n - done, std::memory_order_release);
+            }
+
+            out.framesPending.store(0, std::memory_order_release);
+            outReversed.framesPending.store(0, std::memory_order_release);
+            return true;
+        }
+
+    } // namespace
+
+    LoadedPair loadFileIntoAudioBuffer(juce::AudioFormatManager& fm,
+        const juce::File& file,
+        const std::function<bool()>& shouldAbort)
+    {
+        auto reader = openReader(fm, file);
+        if (!reader) return {};
+
+        auto pair = allocatePair(*reader, 0);
+        if (!decodeInto(*reader, *pair.first, *pair.second, shouldAbort))
+            return {};
+        return pair;
+    }
+
+    bool loadFileProgressively(juce::AudioFormatManager& fm,
+        const juce::File& file,
+        int decodeFrom,
+        const std::function<void(LoadedPair&)>& publish,
+        const std::function<bool()>& shouldAbort)
+    {
+        auto reader = openReader(fm, file);
+        if (!reader) return false;
+
+        auto pair = allocatePair(*reader, decodeFrom);
+        auto& out = *pair.first;
+        auto& outReversed = *pair.second;
+        publish(pair);
+        if (pair.first) return false;   // nobody took it
+
+        return decodeInto(*reader, out, outReversed, shouldAbort);
+    }
+
+    LoadedPair openFileAsStream(juce::AudioFormatManager& fm, const juce::File& file)
+    {
+        auto reader = openReader(fm, file);
+        if (!reader) return {};
+
+        auto stream = std::make_shared<ChunkStream>(std::move(reader));
+        auto makeView = [&](bool reversed) {
+            auto view = std::make_unique<LoadedAudio>();
+            view->sampleRate = stream->getSampleRate();
+            view->numSamples = stream->getNumSamples();
+            view->storage = codec::SampleStorage::streamed;
+            view->stream = stream;
+            view->streamReversed = reversed;
+            return view;
+        };
+        return { makeView(false), makeView(true) };
+    }
+
+    juce::String computeContentHash(const juce::File& file)
+    {
+        juce::FileInputStream in(file);
+        if (!in.openedOk()) return {};
+
+        constexpr juce::int64 window = 1 << 20;
+        const juce::int64 size = in.getTotalLength();
+
+        juce::MemoryBlock bytes;
+        bytes.append(&size, sizeof(size));
+
+        juce::MemoryBlock chunk;
+        chunk.setSize((size_t)std::min(window, size));
+        auto readWindow = [&](juce::int64 from)
+        {
+            in.setPosition(from);
+            const int got = in.read(chunk.getData(), (int)chunk.getSize());
+            if (got > 0) bytes.append(chunk.getData(), (size_t)got);
+        };
+
+        readWindow(0);
+        if (size > window)
+            readWindow(std::max(window, size - window));
+
+        return juce::MD5(bytes).toHexString();
+    }
+
+    TrackLoadJob::TrackLoadJob(const void* owner, const juce::File& file, int deck, int generation,
+        const juce::String& expectedHash, codec::SampleStorage storage, Callback onDone)
+        : juce::ThreadPoolJob("ttvst track load"),
+          owner_(owner), file_(file), deck_(deck), generation_(generation),
+          expectedHash_(expectedHash), storage_(storage), onDone_(std::move(onDone))
+    {
+    }
+
+    juce::ThreadPoolJob::JobStatus TrackLoadJob::runJob()
+    {
+        Result r;
+        r.file = file_;
+        r.deck = deck_;
+        r.generation = generation_;
+        r.contentHash = computeContentHash(file_);
+
+        if (expectedHash_.isNotEmpty() && r.contentHash != expectedHash_)
+            DBG("TrackLoadJob: " << file_.getFileName() << " changed since the session was saved");
+
+        juce::AudioFormatManager fm;
+        fm.registerBasicFormats(); // WAV/AIFF/FLAC/MP3* (MP3 depends on defines)
+
+        if (storage_ == codec::SampleStorage::streamed) {
+            r.audio = openFileAsStream(fm, file_);
+        }
+        else if (onDecoded_ && storage_ == codec::SampleStorage::float32) {
+            // the pair goes out silent and fills in while it plays
+            bool published = false;
+            const bool ok = loadFileProgressively(fm, file_, decodeFrom_, [&](LoadedPair& pair) {
+                if (shouldExit() || !onDone_) return;
+                r.audio = std::move(pair);
+                r.complete = false;
+                onDone_(std::move(r));
+                published = true;
+            }, [this] { return shouldExit(); });
+
+            if (published) {
+                onDecoded_(ok);
+                return jobHasFinished;
+            }
+            // not opened: reported below with no audio, like any failed decode
+        }
+        else {
+            r.audio = loadFileIntoAudioBuffer(fm, file_, [this] { return shouldExit(); });
+        }
+
+        if (r.audio.first && r.audio.second && storage_ != codec::SampleStorage::float32
+            && storage_ != codec::SampleStorage::streamed)
+        {
+            r.audio.first->convertStorage(storage_);
+            r.audio.second->convertStorage(storage_);
+        }
+
+        if (!shouldExit() && onDone_)
+            onDone_(std::move(r));
+
+        return jobHasFinished;
+    }
+
+    void cancelLoadJobsFor(juce::ThreadPool& pool, const void* owner)
+    {
+        struct OwnerSelector : juce::ThreadPool::JobSelector
+        {
+            explicit OwnerSelector(const void* o) : owner(o) {}
+            bool isJobSuitable(juce::ThreadPoolJob* job) override
+            {
+                auto* load = dynamic_cast<TrackLoadJob*>(job);
+                return load != nullptr && load->getOwner() == owner;
+            }
+            const void* owner;
+        };
+
+        OwnerSelector selector(owner);
+        pool.removeAllJobs(true, 5000, &selector);
+    }
+
+} // namespace ttvst
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    TrackLoader.h
+    Background decoding of tracks into LoadedAudio.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <memory>
+#include <utility>
+#include "LoadedAudio.h"
+
+namespace ttvst {
+
+    // Freshly decoded, not yet shared. TrackCache turns these into LoadedAudioPtr.
+    using LoadedPair = std::pair<std::unique_ptr<LoadedAudio>, std::unique_ptr<LoadedAudio>>;
+
+    /**
+     * Decodes the whole file into RAM, plus a reversed copy for backspins.
+     * shouldAbort is polled between read chunks; returns an empty pair on failure/abort.
+     */
+    LoadedPair loadFileIntoAudioBuffer(juce::AudioFormatManager& fm,
+        const juce::File& file,
+        const std::function<bool()>& shouldAbort = {});
+
+    /**
+     * The same decode, published before it starts: `publish` gets the allocated (silent) pair
+     * and moves it out to share it, and the audio is then written in place, chunk by chunk
+     * (LoadedAudio::getDecodedRange says how far it got). Reading starts a chunk before
+     * `decodeFrom`, a cue point say, runs to the end and wraps round to the start.
+     * Whoever took the pair keeps it alive until this returns. False if the file did not
+     * open, publish left the pair, or shouldAbort stopped the decode short.
+     */
+    bool loadFileProgressively(juce::AudioFormatManager& fm,
+        const juce::File& file,
+        int decodeFrom,
+        const std::function<void(LoadedPair&)>& publish,
+        const std::function<bool()>& shouldAbort = {});
+
+    /**
+     * Opens the file for streamed storage: nothing is decoded here, the pair are the forward
+     * and reversed views of one ChunkStream. Returns an empty pair if no reader takes the file.
+     */
+    LoadedPair openFileAsStream(juce::AudioFormatManager& fm, const juce::File& file);
+
+    /**
+     * Cheap identity for a track file: size + MD5 of the first and last MiB.
+     * Good enough to notice a replaced/re-encoded file without reading hours of audio.
+     */
+    juce::String computeContentHash(const juce::File& file);
+
+    /**
+     * One decode pool for every plugin instance in the process, so opening a project
+     * with many instances queues the decodes instead of starting a thread per deck.
+     * Use through juce::SharedResourcePointer<SharedLoaderPool>.
+     */
+    struct SharedLoaderPool
+    {
+        juce::ThreadPool pool{ 2 };
+    };
+
+    /**
+     * Decode job running on SharedLoaderPool. The owner pointer only tags the job
+     * so an instance can cancel its own jobs (see cancelLoadJobsFor).
+     */
+    class TrackLoadJob : public juce::ThreadPoolJob
+    {
+    public:
+        struct Result
+        {
+            LoadedPair   audio;
+            juce::File   file;
+            juce::String contentHash;
+            int          deck = 0;
+            int          generation = 0;
+            bool         complete = true;   // false: published early, still being decoded
+        };
+
+        using Callback = std::function<void(Result&&)>;
+
+        TrackLoadJob(const void* owner, const juce::File& file, int deck, int generation,
+            const juce::String& expectedHash, codec::SampleStorage storage, Callback onDone);
+
+        JobStatus runJob() override;
+
+        /**
+         * Float32 storage only: onDone gets the pair before a sample is decoded (complete
+         * false) and onDecoded(ok) is called once the decode is over, from decodeFrom first
+         * (see loadFileProgressively). Set before the job is queued.
+         */
+        void publishEarly(int decodeFrom, std::function<void(bool ok)> onDecoded)
+        {
+            decodeFrom_ = decodeFrom;
+            onDecoded_ = std::move(onDecoded);
+        }
+
+        const void* getOwner() const noexcept { return owner_; }
+
+    private:
+        const void*  owner_;
+        juce::File   file_;
+        int          deck_;
+        int          generation_;
+        juce::String expectedHash_;
+        codec::SampleStorage storage_;
+        Callback     onDone_;
+        int          decodeFrom_ = 0;
+        std::function<void(bool)> onDecoded_;
+    };
+
+    // Stops and waits for every queued/running job tagged with `owner`.
+    void cancelLoadJobsFor(juce::ThreadPool& pool, const void* owner);
+
+} // namespace ttvst
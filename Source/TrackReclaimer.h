@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    TrackReclaimer.h
+    Frees retired LoadedAudio objects on a background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include "LoadedAudio.h"
+
+namespace ttvst {
+
+    /**
+     * Tracks can be hundreds of MB; whoever drops the last reference should not pay
+     * for the free (least of all processBlock). retire() parks the pointer in a fixed
+     * slot table, a low-priority thread deletes it a few ms later. Should the table be
+     * full, the object goes on a lock-free overflow list threaded through
+     * LoadedAudio::retiredNext, drained by the same thread: retire() never frees.
+     * The same thread polls attached Collectables (see TrackHandle) so their
+     * deferred releases also happen here.
+     */
+    class TrackReclaimer : private juce::Thread
+    {
+    public:
+        struct Collectable
+        {
+            virtual ~Collectable() = default;
+            virtual void collect() = 0;     // reclaimer thread, releases whatever is safe
+        };
+
+        TrackReclaimer() : juce::Thread("ttvst reclaimer")
+        {
+            startThread(juce::Thread::Priority::low);
+        }
+
+        ~TrackReclaimer() override
+        {
+            stopThread(2000);
+            drain();
+            if (const auto n = getOverflows())
+                DBG("TrackReclaimer: " << (int)n << " retirements overflowed the slot table");
+        }
+
+        // Message/loader threads; detach before the Collectable dies
+        void attach(Collectable* c)
+        {
+            const juce::ScopedLock sl(collectLock_);
+            collectables_.push_back(c);
+        }
+
+        void detach(Collectable* c)
+        {
+            const juce::ScopedLock sl(collectLock_);
+            collectables_.erase(std::remove(collectables_.begin(), collectables_.end(), c), collectables_.end());
+        }
+
+        // Any thread, audio thread included: no locks, no allocation
+        void retire(const LoadedAudio* p) noexcept
+        {
+            if (p == nullptr) return;
+
+            const size_t start = hint_.fetch_add(1, std::memory_order_relaxed);
+            for (size_t k = 0; k < capacity; ++k)
+            {
+                auto& slot = slots_[(start + k) & (capacity - 1)];
+                const LoadedAudio* expected = nullptr;
+                if (slot.compare_exchange_strong(expected, p, std::memory_order_acq_rel))
+                    return;
+            }
+
+            // table full (hundreds of retirements within one poll): push onto the overflow list
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            const LoadedAudio* head = overflow_.load(std::memory_order_relaxed);
+            do p->retiredNext = head;
+            while (!overflow_.compare_exchange_weak(head, p, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Retirements that found the slot table full
+        size_t getOverflows() const noexcept { return overflows_.load(std::memory_order_relaxed); }
+
+        // shared_ptr deleter that hands the object to a reclaimer; there is always one
+        class Deleter
+        {
+        public:
+            explicit Deleter(TrackReclaimer& r) noexcept : reclaimer_(&r) {}
+            void operator()(const LoadedAudio* p) const noexcept { reclaimer_->retire(p); }
+
+        private:
+            TrackReclaimer* reclaimer_;
+        };
+
+        LoadedAudioPtr adopt(std::unique_ptr<LoadedAudio> audio)
+        {
+            return LoadedAudioPtr(audio.release(), Deleter(*this));
+        }
+
+    private:
+        static constexpr size_t capacity = 512;   // power-of-two
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                {
+                    const juce::ScopedLock sl(collectLock_);
+                    for (auto* c : collectables_)
+                        c->collect();
+                }
+                drain();
+                wait(50);
+            }
+        }
+
+        void drain() noexcept
+        {
+            for (auto& slot : slots_)
+                if (auto* p = slot.exchange(nullptr, std::memory_order_acq_rel))
+                    delete p;
+
+            // only ever taken whole, so no node is seen twice
+            for (auto* p = overflow_.exchange(nullptr, std::memory_order_acquire); p != nullptr;) {
+                const auto* next = p->retiredNext;
+                delete p;
+                p = next;
+            }
+        }
+
+        std::array<std::atomic<const LoadedAudio*>, capacity> slots_{};
+        std::atomic<size_t> hint_{ 0 };
+        std::atomic<const LoadedAudio*> overflow_{ nullptr };
+        std::atomic<size_t> overflows_{ 0 };
+        std::vector<Collectable*> collectables_;
+        juce::CriticalSection collectLock_;
+
+        JUCE_DECLARE_NON_COPYABLE(TrackReclaimer)
+    };
+
+} // namespace ttvst
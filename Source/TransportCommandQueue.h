@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <cstddef>
+
+namespace ttvst {
+
+    // Transport change requested by a non-audio thread (UI, state restore, loader)
+    struct TransportCommand
+    {
+        enum Type : int { setMotor = 0, setLoop, cueJump, selectDeck, setMotorSpeed, setKeylock, setLoopRegion, setPositionSource,
+                          hotCue, loopFromPlayhead, toggleMotor, toggleReverse, brake, noteOn, noteOff, setSamplerMode,
+                          clearHotCue };
+
+        int    type = setMotor;
+        int    sampleOffset = 0;      // offset within the block it is applied in (0 = block start)
+        int    intValue = 0;          // motor/loop flag (0/1), deck index, keylock mode, loop length, position source, hot cue slot,
+                                      // note number, sampler mode
+        double position = 0.0;        // cue target / loop start in source samples, motor speed, loop length in seconds, velocity
+        int    deck = -1;             // cue jump only: the deck it was meant for, dropped once another is selected (-1 = any)
+    };
+
+    // Inserts c into out[0 .. n) after every command at or before its offset. Returns the new count;
+    // a full list drops c.
+    template <size_t N>
+    int insertByOffset(std::array<TransportCommand, N>& out, int n, const TransportCommand& c) noexcept
+    {
+        if ((size_t)n >= N) return n;
+        // insertion sort, the list is tiny and almost always already ordered
+        int j = n++;
+        while (j > 0 && out[(size_t)j - 1].sampleOffset > c.sampleOffset)
+        {
+            out[(size_t)j] = out[(size_t)j - 1];
+            --j;
+        }
+        out[(size_t)j] = c;
+        return n;
+    }
+
+    /**
+     * Many-producer (message/loader threads), single-consumer (audio thread) command ring.
+     * Producers serialise among themselves; the audio thread side never takes a lock.
+     * Drops on overflow, the caller can check the return value of push().
+     */
+    class TransportCommandQueue
+    {
+    public:
+        static constexpr size_t capacity = 256;          // power-of-two
+
+        TransportCommandQueue() = default;
+
+        // Called from any non-audio thread
+        bool push(const TransportCommand& c) noexcept
+        {
+            std::lock_guard<std::mutex> lock(producerLock_);
+
+            auto w = write_.load(std::memory_order_relaxed);
+            auto next = (w + 1) & mask;
+            if (next == read_.load(std::memory_order_acquire))
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            buffer_[w] = c;
+            write_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Called from processBlock (audio thread). Copies pending commands into `out`,
+        // ordered by sampleOffset (stable, so commands at the same offset keep push order)
+        // and clamped to [0, blockSize). Returns the number of commands written.
+        int drainTo(std::array<TransportCommand, capacity>& out, int blockSize) noexcept
+        {
+            auto r = read_.load(std::memory_order_relaxed);
+            const auto w = write_.load(std::memory_order_acquire);
+
+            int n = 0;
+            while (r != w)
+            {
+                auto c = buffer_[r];
+                r = (r + 1) & mask;
+
+                if (c.sampleOffset < 0) c.sampleOffset = 0;
+                if (c.sampleOffset >= blockSize) c.sampleOffset = blockSize > 0 ? blockSize - 1 : 0;
+
+                n = insertByOffset(out, n, c);
+            }
+            read_.store(r, std::memory_order_release);
+            return n;
+        }
+
+        size_t getAndResetDroppedCount() noexcept
+        {
+            return dropped_.exchange(0, std::memory_order_acq_rel);
+        }
+
+    private:
+        static constexpr size_t mask = capacity - 1;
+
+        std::array<TransportCommand, capacity> buffer_{};
+        std::atomic<size_t> write_{ 0 };
+        std::atomic<size_t> read_{ 0 };
+        std::atomic<size_t> dropped_{ 0 };
+        std::mutex producerLock_;
+    };
+
+} // namespace ttvst
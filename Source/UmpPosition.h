@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    UmpPosition.h
+    Platter position from Universal MIDI Packets: 32-bit pitch bend, per-note
+    pitch bend or a chosen registered/assignable controller.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace ttvst::ump {
+
+    // 32-bit words in a packet, by message type (the top nibble of its first word)
+    inline int wordsForType(uint32_t type) noexcept
+    {
+        static constexpr int words[16] = { 1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4 };
+        return words[type & 0xF];
+    }
+
+    // A MIDI 2.0 controller address: RPN (registered) or NRPN (assignable), bank + index
+    struct ControllerId
+    {
+        enum Kind : uint8_t { none = 0, registered, assignable };
+        Kind kind = none;
+        uint8_t bank = 0, index = 0;
+    };
+
+    /**
+     * Turns position packets into 32-bit wheel values, the full range spanning what the
+     * 14-bit pitch wheel spans (see helps::pitchBend32ToSamplePosition): a controller that
+     * speaks MIDI 2.0 sends the same positions at 2^18 times the resolution.
+     * Accepted: MIDI 2.0 pitch bend and per-note pitch bend (any note), the controller set
+     * with setController, and MIDI 1.0 pitch bend inside a UMP (upscaled).
+     *
+     * Plugin hosts hand processBlock MIDI 1.0 bytes only, so the packets travel tunnelled
+     * in a SysEx message, as a controller's driver or a bridge sends them:
+     *     F0 7D 'U' 'M' 'P'  5 bytes per 32-bit word, top 4 bits first then 7 bits each  F7
+     * Audio thread, no allocation; the decoder keeps no state between messages.
+     */
+    class PositionDecoder
+    {
+    public:
+        // Message thread, before the processor starts
+        void setController(ControllerId c) noexcept { controller_ = c; }
+        ControllerId getController() const noexcept { return controller_; }
+
+        // One packet; true with value set if it carries a position
+        bool decodePacket(const uint32_t* words, int numWords, uint32_t& value) const noexcept
+        {
+            if (numWords < 1) return false;
+            const uint32_t w0 = words[0];
+            const uint32_t type = w0 >> 28, status = (w0 >> 20) & 0xF;
+
+            if (type == 0x2 && status == 0xE) {
+                // MIDI 1.0 pitch bend: the 14-bit value stretched over the 32-bit range
+                const uint32_t v14 = ((w0 & 0x7F) << 7) | ((w0 >> 8) & 0x7F);
+                value = (uint32_t)(((uint64_t)v14 * 0xFFFFFFFFull + 8191) / 16383);
+                return true;
+            }
+            if (type != 0x4 || numWords < 2) return false;
+
+            switch (status) {
+            case 0xE:   // pitch bend
+            case 0x6:   // per-note pitch bend
+                break;
+            case 0x2:   // registered controller
+            case 0x3: { // assignable controller
+                const auto kind = status == 0x2 ? ControllerId::registered : ControllerId::assignable;
+                if (controller_.kind != kind
+                    || ((w0 >> 8) & 0x7F) != controller_.bank || (w0 & 0x7F) != controller_.index)
+                    return false;
+                break;
+            }
+            default:
+                return false;
+            }
+            value = words[1];
+            return true;
+        }
+
+        // A tunnelled envelope (SysEx data without F0/F7); the value of its last position packet
+        bool decodeSysEx(const uint8_t* data, int size, uint32_t& value) const noexcept
+        {
+            constexpr uint8_t header[] = { 0x7D, 'U', 'M', 'P' };
+            constexpr int headerSize = (int)sizeof(header);
+            if (size < headerSize + 5) return false;
+            for (int i = 0; i < headerSize; ++i)
+                if (data[i] != header[i]) return false;
+
+            bool found = false;
+            uint32_t packet[4];
+            int pos = headerSize, numWords = 0, needed = 0;
+            for (; pos + 5 <= size; pos += 5) {
+                const uint8_t* b = data + pos;
+                packet[numWords++] = ((uint32_t)(b[0] & 0x0F) << 28) | ((uint32_t)(b[1] & 0x7F) << 21)
+                    | ((uint32_t)(b[2] & 0x7F) << 14) | ((uint32_t)(b[3] & 0x7F) << 7) | (uint32_t)(b[4] & 0x7F);
+                if (numWords == 1) needed = wordsForType(packet[0] >> 28);
+                if (numWords < needed) continue;
+
+                found = decodePacket(packet, numWords, value) || found;
+                numWords = 0;
+            }
+            return found;
+        }
+
+    private:
+        ControllerId controller_;
+    };
+
+} // namespace ttvst::ump
@@ -13,12 +13,6 @@
 #include<vector>
 #include<algorithm>
 #include<cmath>
-#include <fstream>
-#include <iomanip>
-#include <stdexcept>
-
-#include <string>
-#include <filesystem> // C++17
 
 
 using namespace std;
@@ -67,49 +61,6 @@ namespace ttvst::splines {
 
 
 
-    void save_vector_csv(const std::string& path,
-        const std::vector<double>& v,
-        int precision = 12)
-    {
-        std::ofstream ofs(path);
-        if (!ofs) throw std::runtime_error("Failed to open " + path);
-        ofs << std::fixed << std::setprecision(precision);
-        for (double val : v) ofs << val << '\n';
-        DBG("vector saved");
-    }
-
-    void append_vector_csv(const std::string& path,
-        const std::vector<double>& v,
-        int precision = 12)
-    {
-        if (v.empty()) return; // nothing to append
-
-        // If the file exists and is non-empty, check whether the last byte is '\n'.
-        // If the file doesn't exist, ofstream with ios::app will create it.
-        bool need_leading_newline = false;
-        if (std::filesystem::exists(path)) {
-            std::ifstream ifs(path, std::ios::binary);
-            if (ifs) {
-                ifs.seekg(0, std::ios::end);
-                std::streampos sz = ifs.tellg();
-                if (sz > 0) {
-                    ifs.seekg(-1, std::ios::end);
-                    char last = ifs.get();
-                    if (last != '\n') need_leading_newline = true;
-                }
-            }
-        }
-
-        std::ofstream ofs(path, std::ios::app);
-        if (!ofs) throw std::runtime_error("Failed to open " + path + " for appending");
-
-        ofs << std::fixed << std::setprecision(precision);
-        if (need_leading_newline) ofs << '\n';
-
-        for (double val : v) ofs << val << '\n';
-    }
-
-
     //we wish to find set of n splines S_i(x) for i = 0, ..., i = n - 1	
     vector<splineSet> spline(vec& x, vec& y) {
         // must have at least two points and same length
@@ -9,148 +9,17 @@
 */
 
 #include "helpers.h"
-#include <algorithm>
 
 namespace ttvst::helps {
 
-    
-
-
-    std::optional<juce::MidiMessageMetadata> getLastPitchWheelMessage(const juce::MidiBuffer& buffer){
-
-        std::optional<juce::MidiMessageMetadata> last = std::nullopt;
-        for (auto metadata : buffer)
-        {
-            if (metadata.getMessage().isPitchWheel()) {
-
-                last = metadata;
-            }
-        }
-        return last;
-    }
-
-    std::optional<juce::MidiMessageMetadata> getFirstPitchWheelMessage(const juce::MidiBuffer& buffer) {
-
-        for (auto metadata : buffer)
-        {
-            if (metadata.getMessage().isPitchWheel()) {
-
-                return metadata;
-            }
-        }
-        return std::nullopt;
-    }
-
-    std::optional<ttvst::helps::pairVector> getPitchWheelMsgPairVec(const juce::MidiBuffer& buffer) {
-        pairVector messages;
-        if (buffer.isEmpty()) {
-            return std::nullopt;
-            DBG("No messages in this buffer");
-        }
-        for (const auto metadata : buffer) {
-            const auto& m = metadata.getMessage();
-            if (!m.isPitchWheel()) continue;
-            const int offset = metadata.samplePosition;
-            const int val = m.getPitchWheelValue();
-            intPair msg = { offset, val };
-            messages.push_back(msg);
-            DBG("helpers::pairVec: midi messages in this buffer: " << messages.size());
-        }
-        if (messages.empty()) {
-            return std::nullopt;
-            DBG("No pitch wheel messages in this buffer");
-        }
-        return messages;
-        
-    }
-
-    std::optional<std::vector<double>> getPitchWheelValueVector(const juce::MidiBuffer& buffer) {
-        std::vector<double> values;
-        if (buffer.isEmpty()) {
-            return std::nullopt;
-            DBG("No messages in this buffer");
-        }
-        for (const auto metadata : buffer) {
-            const auto& m = metadata.getMessage();
-            if (!m.isPitchWheel()) continue;
-            int value = m.getPitchWheelValue();
-            values.push_back(value);
-            //DBG("values in this buffer: " << values.size());
-        }
-        if (values.empty()) {
-            return std::nullopt;
-            DBG("No pitch wheel messages in this buffer");
-        }
-        return values;
-    }
-
-    std::optional<std::vector<double>> getPitchWheelOffsetsVector(const juce::MidiBuffer& buffer) {
-        std::vector<double> offsets;
-        if (buffer.isEmpty()) {
-            return std::nullopt;
-            //DBG("No messages in this buffer");
-        }
-        for (const auto metadata : buffer) {
-            const auto& m = metadata.getMessage();
-            if (!m.isPitchWheel()) continue;
-            offsets.push_back(metadata.samplePosition);
-            DBG("helpers::offsetsVector: offsets in this buffer: " << offsets.size());
-        }
-        if (offsets.empty()) {
-            return std::nullopt;
-            //DBG("No pitch wheel messages in this buffer");
-        }
-        return offsets;
-    }
-    
-
-    bool hasPitchWheelMessage(const juce::MidiBuffer& buffer) {
-        for (auto meta : buffer) {
-            if (meta.getMessage().isPitchWheel()) {
-                return true;
-            }        
-        }
-        return false;
-    }
-
-    std::vector<double> pitchWheelToSamplePositionVec(std::vector<double> values) {
-        if (!values.empty()) {
-            std::for_each(values.begin(), values.end(), [](double& n) {
-                n = (n / 16383.0) * 2.0 * 48000.0;
-                });
-            return values;
-        }
-        else {
-            DBG("pitchToSample: values are empty");
-        }
-
-    }
-
     double pitchWheelToSamplePosition(const double value) {
         return (value / 16383.0) * 2.0 * 48000.0;
     }
 
-    std::vector<double> createRatiosVector(std::vector<double> Y, std::optional<double> preRenderValue) {
-        if (Y.size() < 2) {
-            return {};
-        }
-        std::vector<double> ratios;
-        ratios.reserve(Y.size());
-
-        if (preRenderValue.has_value()) {
-            ratios.push_back(Y[0] - *preRenderValue);
-        }
-
-
-        for (int i = 0; i + 1 < Y.size(); i++) {
-            ratios.push_back(Y[i + 1] - Y[i]);
-        }
-        return ratios;
-
-
+    double pitchBend32ToSamplePosition(const uint32_t value) {
+        return ((double)value / 4294967295.0) * 2.0 * 48000.0;
     }
 
-
 }
 
 